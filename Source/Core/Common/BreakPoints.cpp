@@ -9,6 +9,9 @@
 #include "Common/BreakPoints.h"
 #include "Common/CommonTypes.h"
 #include "Common/DebugInterface.h"
+#include "Core/Core.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PowerPC/JitInterface.h"
 #include "Core/PowerPC/JitCommon/JitBase.h"
 #include "Core/PowerPC/JitCommon/JitCache.h"
 
@@ -166,7 +169,11 @@ void MemChecks::AddFromStrings(const TMemChecksStr& mcstrs)
 void MemChecks::Add(const TMemCheck& _rMemoryCheck)
 {
 	if (GetMemCheck(_rMemoryCheck.StartAddress) == nullptr)
+	{
+		bool had_any = HasAny();
 		m_MemChecks.push_back(_rMemoryCheck);
+		Update(had_any);
+	}
 }
 
 void MemChecks::Remove(u32 _Address)
@@ -176,11 +183,31 @@ void MemChecks::Remove(u32 _Address)
 		if (i->StartAddress == _Address)
 		{
 			m_MemChecks.erase(i);
+			Update(true);
 			return;
 		}
 	}
 }
 
+void MemChecks::Clear()
+{
+	bool had_any = HasAny();
+	m_MemChecks.clear();
+	Update(had_any);
+}
+
+// The watched pages are protected in the fastmem views, so only the JIT code
+// that touches them leaves its fast path. The few fast paths that can't be
+// backpatched are only compiled while there are no memchecks at all.
+void MemChecks::Update(bool had_any)
+{
+	bool was_unpaused = Core::PauseAndLock(true);
+	Memory::UpdateMemCheckProtection();
+	if (had_any != HasAny())
+		JitInterface::ClearCache();
+	Core::PauseAndLock(false, was_unpaused);
+}
+
 TMemCheck *MemChecks::GetMemCheck(u32 address)
 {
 	for (TMemCheck& bp : m_MemChecks)
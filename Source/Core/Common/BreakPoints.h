@@ -104,7 +104,11 @@ public:
 	TMemCheck *GetMemCheck(u32 address);
 	void Remove(u32 _Address);
 
-	void Clear() { m_MemChecks.clear(); }
+	void Clear();
+	bool HasAny() const { return !m_MemChecks.empty(); }
+
+private:
+	void Update(bool had_any);
 };
 
 class Watches
@@ -0,0 +1,212 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <cinttypes>
+#include <cstdarg>
+#include <cstring>
+#include <mutex>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Common/JitRegister.h"
+#include "Common/StringUtil.h"
+#include "Common/Logging/Log.h"
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <elf.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#define JIT_REGISTER_JITDUMP
+#endif
+
+namespace JitRegister
+{
+
+static std::mutex s_lock;
+static File::IOFile s_perf_map_file;
+
+#ifdef JIT_REGISTER_JITDUMP
+// See tools/perf/Documentation/jitdump-specification.txt in the kernel tree.
+enum
+{
+	JITDUMP_MAGIC = 0x4A695444,
+	JITDUMP_VERSION = 1,
+	JIT_CODE_LOAD = 0,
+	JIT_CODE_CLOSE = 3,
+};
+
+struct JitDumpHeader
+{
+	u32 magic;
+	u32 version;
+	u32 total_size;
+	u32 elf_mach;
+	u32 pad1;
+	u32 pid;
+	u64 timestamp;
+	u64 flags;
+};
+
+struct JitDumpRecordHeader
+{
+	u32 id;
+	u32 total_size;
+	u64 timestamp;
+};
+
+struct JitDumpCodeLoad
+{
+	JitDumpRecordHeader header;
+	u32 pid;
+	u32 tid;
+	u64 vma;
+	u64 code_addr;
+	u64 code_size;
+	u64 code_index;
+	// Followed by the NUL terminated name and the code itself.
+};
+
+static File::IOFile s_jitdump_file;
+static void* s_jitdump_marker;
+static u64 s_code_index;
+
+// perf matches the records against its samples by CLOCK_MONOTONIC time.
+static u64 GetTimestamp()
+{
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (u64)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void OpenJitDump(const std::string& filename)
+{
+	if (!s_jitdump_file.Open(filename, "w+b"))
+		return;
+
+	JitDumpHeader header = {};
+	header.magic = JITDUMP_MAGIC;
+	header.version = JITDUMP_VERSION;
+	header.total_size = sizeof(header);
+	header.elf_mach = EM_X86_64;
+	header.pid = getpid();
+	header.timestamp = GetTimestamp();
+	s_jitdump_file.WriteBytes(&header, sizeof(header));
+
+	// perf only finds the dump through an executable mapping of it showing up
+	// in the trace.
+	s_jitdump_marker = mmap(nullptr, sysconf(_SC_PAGESIZE), PROT_READ | PROT_EXEC, MAP_PRIVATE,
+	                        fileno(s_jitdump_file.GetHandle()), 0);
+	if (s_jitdump_marker == MAP_FAILED)
+	{
+		s_jitdump_marker = nullptr;
+		s_jitdump_file.Close();
+		ERROR_LOG(COMMON, "Failed to map jitdump file %s", filename.c_str());
+		return;
+	}
+	s_code_index = 0;
+}
+
+static void CloseJitDump()
+{
+	if (!s_jitdump_file.IsOpen())
+		return;
+
+	JitDumpRecordHeader close = { JIT_CODE_CLOSE, sizeof(close), GetTimestamp() };
+	s_jitdump_file.WriteBytes(&close, sizeof(close));
+	munmap(s_jitdump_marker, sysconf(_SC_PAGESIZE));
+	s_jitdump_marker = nullptr;
+	s_jitdump_file.Close();
+}
+
+static void WriteJitDump(const void* base_address, u32 code_size, const char* name)
+{
+	size_t name_size = strlen(name) + 1;
+
+	JitDumpCodeLoad record;
+	record.header.id = JIT_CODE_LOAD;
+	record.header.total_size = (u32)(sizeof(record) + name_size + code_size);
+	record.header.timestamp = GetTimestamp();
+	record.pid = getpid();
+	record.tid = (u32)syscall(SYS_gettid);
+	record.vma = (u64)base_address;
+	record.code_addr = (u64)base_address;
+	record.code_size = code_size;
+	record.code_index = s_code_index++;
+
+	s_jitdump_file.WriteBytes(&record, sizeof(record));
+	s_jitdump_file.WriteBytes(name, name_size);
+	s_jitdump_file.WriteBytes(base_address, code_size);
+}
+#endif
+
+void Init(const std::string& perf_dir)
+{
+	std::lock_guard<std::mutex> lk(s_lock);
+	if (perf_dir.empty())
+		return;
+
+#ifdef _WIN32
+	WARN_LOG(COMMON, "perf map files are not supported on this platform");
+#else
+	std::string filename = StringFromFormat("%s/perf-%d.map", perf_dir.c_str(), getpid());
+	if (s_perf_map_file.Open(filename, "w"))
+	{
+		// Disable buffering so the file is usable when Dolphin crashes.
+		setvbuf(s_perf_map_file.GetHandle(), nullptr, _IONBF, 0);
+	}
+	else
+	{
+		ERROR_LOG(COMMON, "Failed to create perf map file %s", filename.c_str());
+	}
+#endif
+
+#ifdef JIT_REGISTER_JITDUMP
+	OpenJitDump(StringFromFormat("%s/jit-%d.dump", perf_dir.c_str(), getpid()));
+#endif
+}
+
+void Shutdown()
+{
+	std::lock_guard<std::mutex> lk(s_lock);
+	s_perf_map_file.Close();
+#ifdef JIT_REGISTER_JITDUMP
+	CloseJitDump();
+#endif
+}
+
+bool IsEnabled()
+{
+	bool enabled = s_perf_map_file.IsOpen();
+#ifdef JIT_REGISTER_JITDUMP
+	enabled |= s_jitdump_file.IsOpen();
+#endif
+	return enabled;
+}
+
+void Register(const void* base_address, u32 code_size, const char* format, ...)
+{
+	if (!IsEnabled() || code_size == 0)
+		return;
+
+	char name[256];
+	va_list args;
+	va_start(args, format);
+	CharArrayFromFormatV(name, sizeof(name), format, args);
+	va_end(args);
+
+	std::lock_guard<std::mutex> lk(s_lock);
+	if (s_perf_map_file.IsOpen())
+		fprintf(s_perf_map_file.GetHandle(), "%" PRIx64 " %x %s\n", (u64)(uintptr_t)base_address, code_size, name);
+#ifdef JIT_REGISTER_JITDUMP
+	if (s_jitdump_file.IsOpen())
+		WriteJitDump(base_address, code_size, name);
+#endif
+}
+
+}
@@ -0,0 +1,43 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+// Tells external profilers about code generated at runtime, so that they can
+// show names instead of anonymous memory.
+//
+// Two formats understood by Linux perf are supported, both written to the
+// directory given to Init():
+//   perf-<pid>.map  - one "start size name" line per region. Only picked up
+//                     by perf if the directory is /tmp.
+//   jit-<pid>.dump  - the jitdump format, which also carries a copy of the
+//                     generated code so perf annotate works. Use with
+//                     "perf record -k mono" and "perf inject --jit".
+
+#pragma once
+
+#include <string>
+
+#include "Common/CommonTypes.h"
+
+namespace JitRegister
+{
+
+void Init(const std::string& perf_dir);
+void Shutdown();
+
+bool IsEnabled();
+
+// Announces the code in [base_address, base_address + code_size). The name
+// is formatted printf style. Safe to call from any thread.
+void Register(const void* base_address, u32 code_size, const char* format, ...)
+#ifdef __GNUC__
+	__attribute__((format(printf, 3, 4)))
+#endif
+	;
+
+inline void Register(const void* start, const void* end, const char* name)
+{
+	Register(start, (u32)((const u8*)end - (const u8*)start), "%s", name);
+}
+
+}
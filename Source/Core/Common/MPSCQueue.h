@@ -0,0 +1,104 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+// a lock-free thread-safe,
+// single reader, multiple writer queue
+
+#include <atomic>
+#include <utility>
+
+namespace Common
+{
+
+// Writers push onto a linked stack with a single compare-and-swap. The reader takes the whole
+// stack at once and reverses it into its own list, so that elements come out in the order each
+// writer pushed them. Since the reader only ever swaps the stack for an empty one, nodes are
+// never reused while a writer might still be looking at them.
+template <typename T>
+class MPSCQueue
+{
+public:
+	MPSCQueue() : m_head(nullptr), m_read_ptr(nullptr) {}
+
+	~MPSCQueue()
+	{
+		Clear();
+	}
+
+	// Can be called from any thread.
+	template <typename Arg>
+	void Push(Arg&& t)
+	{
+		Node* node = new Node(std::forward<Arg>(t));
+		node->next = m_head.load(std::memory_order_relaxed);
+		while (!m_head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed))
+			;
+	}
+
+	// The rest may only be called from the reading thread.
+	bool Empty() const
+	{
+		return !m_read_ptr && !m_head.load(std::memory_order_acquire);
+	}
+
+	bool Pop(T& t)
+	{
+		if (!m_read_ptr)
+		{
+			Node* node = m_head.exchange(nullptr, std::memory_order_acquire);
+			while (node)
+			{
+				Node* next = node->next;
+				node->next = m_read_ptr;
+				m_read_ptr = node;
+				node = next;
+			}
+			if (!m_read_ptr)
+				return false;
+		}
+
+		Node* node = m_read_ptr;
+		m_read_ptr = node->next;
+		t = std::move(node->current);
+		delete node;
+		return true;
+	}
+
+	// not thread-safe
+	void Clear()
+	{
+		FreeList(m_read_ptr);
+		FreeList(m_head.exchange(nullptr));
+		m_read_ptr = nullptr;
+	}
+
+private:
+	struct Node
+	{
+		template <typename Arg>
+		explicit Node(Arg&& t) : current(std::forward<Arg>(t)), next(nullptr) {}
+
+		T current;
+		Node* next;
+	};
+
+	static void FreeList(Node* node)
+	{
+		while (node)
+		{
+			Node* next = node->next;
+			delete node;
+			node = next;
+		}
+	}
+
+	// The writers' stack, newest first.
+	std::atomic<Node*> m_head;
+	// The reader's list, oldest first.
+	Node* m_read_ptr;
+};
+
+}
@@ -170,6 +170,16 @@ void XEmitter::ABI_CallFunctionPPC(const void *func, void *param1, void *param2,
 	ABI_CallFunction(func);
 }
 
+void XEmitter::ABI_CallFunctionPCA(int bits, const void *func, void *param1, u32 param2, const Gen::OpArg &arg3)
+{
+	// arg3 may be in one of the other parameter registers, so it goes first.
+	if (!arg3.IsSimpleReg(ABI_PARAM3))
+		MOV(bits, R(ABI_PARAM3), arg3);
+	MOV(64, R(ABI_PARAM1), Imm64((u64)param1));
+	MOV(32, R(ABI_PARAM2), Imm32(param2));
+	ABI_CallFunction(func);
+}
+
 // Pass a register as a parameter.
 void XEmitter::ABI_CallFunctionR(const void *func, X64Reg reg1)
 {
@@ -773,6 +773,18 @@ public:
 	void VSHUFPD(X64Reg regOp1, X64Reg regOp2, OpArg arg, u8 shuffle);
 	void VUNPCKLPD(X64Reg regOp1, X64Reg regOp2, OpArg arg);
 	void VUNPCKHPD(X64Reg regOp1, X64Reg regOp2, OpArg arg);
+	void VANDPD(X64Reg regOp1, X64Reg regOp2, OpArg arg);
+	void VANDNPD(X64Reg regOp1, X64Reg regOp2, OpArg arg);
+	void VORPD(X64Reg regOp1, X64Reg regOp2, OpArg arg);
+	void VXORPD(X64Reg regOp1, X64Reg regOp2, OpArg arg);
+	void VCMPSD(X64Reg regOp1, X64Reg regOp2, OpArg arg, u8 compare);
+	void VCMPPD(X64Reg regOp1, X64Reg regOp2, OpArg arg, u8 compare);
+	void VMOVDDUP(X64Reg regOp, OpArg arg);
+
+	// AVX: variable blend instructions (explicit mask register, regOp1 = mask ? arg : regOp2)
+	void VPBLENDVB(X64Reg regOp1, X64Reg regOp2, OpArg arg, X64Reg mask);
+	void VBLENDVPS(X64Reg regOp1, X64Reg regOp2, OpArg arg, X64Reg mask);
+	void VBLENDVPD(X64Reg regOp1, X64Reg regOp2, OpArg arg, X64Reg mask);
 
 	// FMA
 	void VFMADD132PS(X64Reg regOp1, X64Reg regOp2, OpArg arg);
@@ -871,6 +883,7 @@ public:
 	void ABI_CallFunctionCCCP(const void *func, u32 param1, u32 param2,u32 param3, void *param4);
 	void ABI_CallFunctionPC(const void *func, void *param1, u32 param2);
 	void ABI_CallFunctionPPC(const void *func, void *param1, void *param2, u32 param3);
+	void ABI_CallFunctionPCA(int bits, const void *func, void *param1, u32 param2, const OpArg &arg3);
 	void ABI_CallFunctionAC(int bits, const void *func, const OpArg &arg1, u32 param2);
 	void ABI_CallFunctionA(int bits, const void *func, const OpArg &arg1);
 
@@ -932,6 +945,14 @@ public:
 		auto trampoline = (void(*)())&XEmitter::CallLambdaTrampoline<T, Args...>;
 		ABI_CallFunctionPC((void*)trampoline, const_cast<void*>((const void*)f), p1);
 	}
+
+	// Same, with a second argument that is already a 32 bit value.
+	template <typename T, typename... Args>
+	void ABI_CallLambdaCA(const std::function<T(Args...)>* f, u32 p1, const OpArg& arg2)
+	{
+		auto trampoline = (void(*)())&XEmitter::CallLambdaTrampoline<T, Args...>;
+		ABI_CallFunctionPCA(32, (void*)trampoline, const_cast<void*>((const void*)f), p1, arg2);
+	}
 };  // class XEmitter
 
 class X64CodeBlock : public CodeBlock<XEmitter>
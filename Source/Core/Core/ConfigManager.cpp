@@ -210,6 +210,7 @@ void SConfig::SaveGeneralSettings(IniFile& ini)
 	general->Set("RecursiveISOPaths", m_RecursiveISOFolder);
 	general->Set("NANDRootPath", m_NANDPath);
 	general->Set("WirelessMac", m_WirelessMac);
+	general->Set("PerfMapDir", m_perfDir);
 
 #ifdef USE_GDBSTUB
 	general->Set("GDBPort", m_LocalCoreStartupParameter.iGDBPort);
@@ -309,8 +310,15 @@ void SConfig::SaveCoreSettings(IniFile& ini)
 	IniFile::Section* core = ini.GetOrCreateSection("Core");
 
 	core->Set("HLE_BS2", m_LocalCoreStartupParameter.bHLE_BS2);
+	core->Set("HLE_SDK", m_LocalCoreStartupParameter.bHLE_SDK);
 	core->Set("CPUCore", m_LocalCoreStartupParameter.iCPUCore);
 	core->Set("Fastmem", m_LocalCoreStartupParameter.bFastmem);
+	core->Set("JITDiskCache", m_LocalCoreStartupParameter.bJITDiskCache);
+	core->Set("JITTieredCompilation", m_LocalCoreStartupParameter.bJITTieredCompilation);
+	core->Set("ProfileCallStacks", m_LocalCoreStartupParameter.bProfileCallStacks);
+	core->Set("ProfileMMIO", m_LocalCoreStartupParameter.bProfileMMIO);
+	core->Set("JITDeferredCompilation", m_LocalCoreStartupParameter.bJITDeferredCompilation);
+	core->Set("JITPartialEviction", m_LocalCoreStartupParameter.bJITPartialEviction);
 	core->Set("CPUThread", m_LocalCoreStartupParameter.bCPUThread);
 	core->Set("DSPHLE", m_LocalCoreStartupParameter.bDSPHLE);
 	core->Set("SkipIdle", m_LocalCoreStartupParameter.bSkipIdle);
@@ -429,6 +437,7 @@ void SConfig::LoadGeneralSettings(IniFile& ini)
 	DiscIO::cUIDsys::AccessInstance().UpdateLocation();
 	DiscIO::CSharedContent::AccessInstance().UpdateLocation();
 	general->Get("WirelessMac", &m_WirelessMac);
+	general->Get("PerfMapDir", &m_perfDir, "");
 }
 
 void SConfig::LoadInterfaceSettings(IniFile& ini)
@@ -528,14 +537,21 @@ void SConfig::LoadCoreSettings(IniFile& ini)
 	IniFile::Section* core = ini.GetOrCreateSection("Core");
 
 	core->Get("HLE_BS2",      &m_LocalCoreStartupParameter.bHLE_BS2, false);
+	core->Get("HLE_SDK",      &m_LocalCoreStartupParameter.bHLE_SDK, false);
 #ifdef _M_X86
 	core->Get("CPUCore",      &m_LocalCoreStartupParameter.iCPUCore, SCoreStartupParameter::CORE_JIT64);
 #elif _M_ARM_32
 	core->Get("CPUCore",      &m_LocalCoreStartupParameter.iCPUCore, SCoreStartupParameter::CORE_JITARM);
 #else
-	core->Get("CPUCore",      &m_LocalCoreStartupParameter.iCPUCore, SCoreStartupParameter::CORE_INTERPRETER);
+	core->Get("CPUCore",      &m_LocalCoreStartupParameter.iCPUCore, SCoreStartupParameter::CORE_CACHEDINTERPRETER);
 #endif
 	core->Get("Fastmem",           &m_LocalCoreStartupParameter.bFastmem,      true);
+	core->Get("JITDiskCache",      &m_LocalCoreStartupParameter.bJITDiskCache, false);
+	core->Get("JITTieredCompilation", &m_LocalCoreStartupParameter.bJITTieredCompilation, false);
+	core->Get("ProfileCallStacks", &m_LocalCoreStartupParameter.bProfileCallStacks, false);
+	core->Get("ProfileMMIO", &m_LocalCoreStartupParameter.bProfileMMIO, false);
+	core->Get("JITDeferredCompilation", &m_LocalCoreStartupParameter.bJITDeferredCompilation, false);
+	core->Get("JITPartialEviction", &m_LocalCoreStartupParameter.bJITPartialEviction, true);
 	core->Get("DSPHLE",            &m_LocalCoreStartupParameter.bDSPHLE,       true);
 	core->Get("CPUThread",         &m_LocalCoreStartupParameter.bCPUThread,    true);
 	core->Get("SkipIdle",          &m_LocalCoreStartupParameter.bSkipIdle,     true);
@@ -90,6 +90,10 @@ struct SConfig : NonCopyable
 	bool m_ColorCompressed;
 
 	std::string m_WirelessMac;
+
+	// Where to write perf map/jitdump files for JIT generated code, empty to disable
+	std::string m_perfDir;
+
 	bool m_PauseMovie;
 	bool m_ShowLag;
 	bool m_ShowFrameCount;
@@ -14,6 +14,7 @@
 #include "Common/CommonPaths.h"
 #include "Common/CommonTypes.h"
 #include "Common/CPUDetect.h"
+#include "Common/JitRegister.h"
 #include "Common/MathUtil.h"
 #include "Common/MemoryUtil.h"
 #include "Common/StringUtil.h"
@@ -333,10 +334,14 @@ void EmuThread()
 
 	Movie::Init();
 
+	// Before anything that generates code.
+	JitRegister::Init(SConfig::GetInstance().m_perfDir);
+
 	HW::Init();
 
 	if (!g_video_backend->Initialize(s_window_handle))
 	{
+		JitRegister::Shutdown();
 		PanicAlert("Failed to initialize video backend!");
 		Host_Message(WM_USER_STOP);
 		return;
@@ -353,6 +358,7 @@ void EmuThread()
 	{
 		HW::Shutdown();
 		g_video_backend->Shutdown();
+		JitRegister::Shutdown();
 		PanicAlert("Failed to initialize DSP emulator!");
 		Host_Message(WM_USER_STOP);
 		return;
@@ -490,6 +496,7 @@ void EmuThread()
 	INFO_LOG(CONSOLE, "Stop [Video Thread]\t\t---- Shutdown complete ----");
 	Movie::Shutdown();
 	PatchEngine::Shutdown();
+	JitRegister::Shutdown();
 
 	s_is_stopping = false;
 
@@ -24,6 +24,9 @@
 SCoreStartupParameter::SCoreStartupParameter()
 : bEnableDebugging(false), bAutomaticStart(false), bBootToPause(false),
   bJITNoBlockCache(false), bJITNoBlockLinking(false),
+  bJITDiskCache(false), bJITTieredCompilation(false),
+  bJITDeferredCompilation(false), bJITPartialEviction(true),
+  bProfileCallStacks(false), bProfileMMIO(false),
   bJITOff(false),
   bJITLoadStoreOff(false), bJITLoadStorelXzOff(false),
   bJITLoadStorelwzOff(false), bJITLoadStorelbzxOff(false),
@@ -35,7 +38,7 @@ SCoreStartupParameter::SCoreStartupParameter()
   bFPRF(false),
   bCPUThread(true), bDSPThread(false), bDSPHLE(true),
   bSkipIdle(true), bNTSC(false), bForceNTSCJ(false),
-  bHLE_BS2(true), bEnableCheats(false),
+  bHLE_BS2(true), bHLE_SDK(false), bEnableCheats(false),
   bMergeBlocks(false), bEnableMemcardSaving(true),
   bDPL2Decoder(false), iLatency(14),
   bRunCompareServer(false), bRunCompareClient(false),
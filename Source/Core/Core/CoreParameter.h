@@ -138,12 +138,18 @@ struct SCoreStartupParameter
 		CORE_JIT64,
 		CORE_JITIL64,
 		CORE_JITARM,
-		CORE_JITARM64
+		CORE_JITARM64,
+		CORE_CACHEDINTERPRETER
 	};
 	int iCPUCore;
 
 	// JIT (shared between JIT and JITIL)
 	bool bJITNoBlockCache, bJITNoBlockLinking;
+	bool bJITDiskCache;
+	bool bJITTieredCompilation;
+	bool bJITDeferredCompilation;
+	bool bJITPartialEviction;
+	bool bProfileCallStacks, bProfileMMIO;
 	bool bJITOff;
 	bool bJITLoadStoreOff, bJITLoadStorelXzOff, bJITLoadStorelwzOff, bJITLoadStorelbzxOff;
 	bool bJITLoadStoreFloatingOff;
@@ -166,6 +172,7 @@ struct SCoreStartupParameter
 	bool bNTSC;
 	bool bForceNTSCJ;
 	bool bHLE_BS2;
+	bool bHLE_SDK;
 	bool bEnableCheats;
 	bool bMergeBlocks;
 	bool bEnableMemcardSaving;
@@ -2,18 +2,21 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <cinttypes>
+#include <functional>
 #include <string>
 #include <vector>
 
 #include "Common/ChunkFile.h"
-#include "Common/FifoQueue.h"
+#include "Common/MPSCQueue.h"
 #include "Common/StringUtil.h"
 #include "Common/Thread.h"
 
 #include "Core/Core.h"
 #include "Core/CoreTiming.h"
 #include "Core/PowerPC/PowerPC.h"
+#include "Core/PowerPC/Profiler.h"
 
 #include "VideoCommon/VideoBackendBase.h"
 
@@ -30,22 +33,26 @@ struct EventType
 
 static std::vector<EventType> event_types;
 
-struct BaseEvent
+struct Event
 {
 	s64 time;
+	// Events that are due at the same time run in the order they were scheduled in.
+	u64 fifo_order;
 	u64 userdata;
 	int type;
-};
 
-typedef LinkedListItem<BaseEvent> Event;
+	bool operator>(const Event& other) const
+	{
+		return time > other.time || (time == other.time && fifo_order > other.fifo_order);
+	}
+};
 
 // STATE_TO_SAVE
-static Event *first;
-static std::mutex tsWriteLock;
-static Common::FifoQueue<BaseEvent, false> tsQueue;
-
-// event pools
-static Event *eventPool = nullptr;
+// A min-heap on (time, fifo_order), maintained with std::push_heap and std::pop_heap.
+static std::vector<Event> event_queue;
+static u64 event_fifo_id;
+// Events scheduled from other threads, until the CPU thread moves them into event_queue.
+static Common::MPSCQueue<Event> ts_queue;
 
 int slicelength;
 static int maxSliceLength = MAX_SLICE_LENGTH;
@@ -63,22 +70,6 @@ static int ev_lost;
 
 static void (*advanceCallback)(int cyclesExecuted) = nullptr;
 
-static Event* GetNewEvent()
-{
-	if (!eventPool)
-		return new Event;
-
-	Event* ev = eventPool;
-	eventPool = ev->next;
-	return ev;
-}
-
-static void FreeEvent(Event* ev)
-{
-	ev->next = eventPool;
-	eventPool = ev;
-}
-
 static void EmptyTimedCallback(u64 userdata, int cyclesLate) {}
 
 int RegisterEvent(const std::string& name, TimedCallback callback)
@@ -107,7 +98,7 @@ int RegisterEvent(const std::string& name, TimedCallback callback)
 
 void UnregisterAllEvents()
 {
-	if (first)
+	if (!event_queue.empty())
 		PanicAlertT("Cannot unregister events with events pending");
 	event_types.clear();
 }
@@ -124,20 +115,12 @@ void Init()
 
 void Shutdown()
 {
-	std::lock_guard<std::mutex> lk(tsWriteLock);
 	MoveEvents();
 	ClearPendingEvents();
 	UnregisterAllEvents();
-
-	while (eventPool)
-	{
-		Event *ev = eventPool;
-		eventPool = ev->next;
-		delete ev;
-	}
 }
 
-static void EventDoState(PointerWrap &p, BaseEvent* ev)
+static void EventDoState(PointerWrap &p, Event* ev)
 {
 	p.Do(ev->time);
 
@@ -171,9 +154,16 @@ static void EventDoState(PointerWrap &p, BaseEvent* ev)
 	}
 }
 
+// The events in the order they will run in.
+static std::vector<Event> GetSortedEvents()
+{
+	std::vector<Event> events = event_queue;
+	std::sort(events.begin(), events.end(), [](const Event& a, const Event& b) { return b > a; });
+	return events;
+}
+
 void DoState(PointerWrap &p)
 {
-	std::lock_guard<std::mutex> lk(tsWriteLock);
 	p.Do(slicelength);
 	p.Do(globalTimer);
 	p.Do(idledCycles);
@@ -185,7 +175,37 @@ void DoState(PointerWrap &p)
 
 	MoveEvents();
 
-	p.DoLinkedList<BaseEvent, GetNewEvent, FreeEvent, EventDoState>(first);
+	// Same layout as the linked list that used to hold the events: each event in the order
+	// they run in, preceded by a 1, and a 0 at the end.
+	if (p.GetMode() == PointerWrap::MODE_READ)
+	{
+		event_queue.clear();
+		event_fifo_id = 0;
+		while (true)
+		{
+			u8 more = 0;
+			p.Do(more);
+			if (!more)
+				break;
+
+			Event ev;
+			EventDoState(p, &ev);
+			ev.fifo_order = event_fifo_id++;
+			event_queue.push_back(ev);
+		}
+		std::make_heap(event_queue.begin(), event_queue.end(), std::greater<Event>());
+	}
+	else
+	{
+		for (Event& ev : GetSortedEvents())
+		{
+			u8 more = 1;
+			p.Do(more);
+			EventDoState(p, &ev);
+		}
+		u8 more = 0;
+		p.Do(more);
+	}
 	p.DoMarker("CoreTimingEvents");
 }
 
@@ -203,12 +223,12 @@ u64 GetIdleTicks()
 // schedule things to be executed on the main thread.
 void ScheduleEvent_Threadsafe(int cyclesIntoFuture, int event_type, u64 userdata)
 {
-	std::lock_guard<std::mutex> lk(tsWriteLock);
 	Event ne;
 	ne.time = globalTimer + cyclesIntoFuture;
+	ne.fifo_order = 0; // assigned once it's on the CPU thread
 	ne.type = event_type;
 	ne.userdata = userdata;
-	tsQueue.Push(ne);
+	ts_queue.Push(ne);
 }
 
 // Same as ScheduleEvent_Threadsafe(0, ...) EXCEPT if we are already on the CPU thread
@@ -227,30 +247,22 @@ void ScheduleEvent_Threadsafe_Immediate(int event_type, u64 userdata)
 
 void ClearPendingEvents()
 {
-	while (first)
-	{
-		Event *e = first->next;
-		FreeEvent(first);
-		first = e;
-	}
+	event_queue.clear();
 }
 
-static void AddEventToQueue(Event* ne)
+static void AddEventToQueue(Event& ne)
 {
-	Event* prev = nullptr;
-	Event** pNext = &first;
-	for (;;)
-	{
-		Event*& next = *pNext;
-		if (!next || ne->time < next->time)
-		{
-			ne->next = next;
-			next = ne;
-			break;
-		}
-		prev = next;
-		pNext = &prev->next;
-	}
+	ne.fifo_order = event_fifo_id++;
+	event_queue.push_back(ne);
+	std::push_heap(event_queue.begin(), event_queue.end(), std::greater<Event>());
+}
+
+static Event PopEvent()
+{
+	std::pop_heap(event_queue.begin(), event_queue.end(), std::greater<Event>());
+	Event evt = event_queue.back();
+	event_queue.pop_back();
+	return evt;
 }
 
 // This must be run ONLY from within the CPU thread
@@ -258,10 +270,10 @@ static void AddEventToQueue(Event* ne)
 // than Advance
 void ScheduleEvent(int cyclesIntoFuture, int event_type, u64 userdata)
 {
-	Event *ne = GetNewEvent();
-	ne->userdata = userdata;
-	ne->type = event_type;
-	ne->time = globalTimer + cyclesIntoFuture;
+	Event ne;
+	ne.userdata = userdata;
+	ne.type = event_type;
+	ne.time = globalTimer + cyclesIntoFuture;
 	AddEventToQueue(ne);
 }
 
@@ -272,55 +284,16 @@ void RegisterAdvanceCallback(void (*callback)(int cyclesExecuted))
 
 bool IsScheduled(int event_type)
 {
-	if (!first)
-		return false;
-	Event *e = first;
-	while (e)
-	{
-		if (e->type == event_type)
-			return true;
-		e = e->next;
-	}
-	return false;
+	return std::any_of(event_queue.begin(), event_queue.end(), [event_type](const Event& e) { return e.type == event_type; });
 }
 
 void RemoveEvent(int event_type)
 {
-	if (!first)
-		return;
-
-	while (first)
+	auto it = std::remove_if(event_queue.begin(), event_queue.end(), [event_type](const Event& e) { return e.type == event_type; });
+	if (it != event_queue.end())
 	{
-		if (first->type == event_type)
-		{
-			Event *next = first->next;
-			FreeEvent(first);
-			first = next;
-		}
-		else
-		{
-			break;
-		}
-	}
-
-	if (!first)
-		return;
-
-	Event *prev = first;
-	Event *ptr = prev->next;
-	while (ptr)
-	{
-		if (ptr->type == event_type)
-		{
-			prev->next = ptr->next;
-			FreeEvent(ptr);
-			ptr = prev->next;
-		}
-		else
-		{
-			prev = ptr;
-			ptr = ptr->next;
-		}
+		event_queue.erase(it, event_queue.end());
+		std::make_heap(event_queue.begin(), event_queue.end(), std::greater<Event>());
 	}
 }
 
@@ -355,71 +328,47 @@ void ProcessFifoWaitEvents()
 {
 	MoveEvents();
 
-	if (!first)
-		return;
-
-	while (first)
+	while (!event_queue.empty() && event_queue.front().time <= globalTimer)
 	{
-		if (first->time <= globalTimer)
-		{
-			Event* evt = first;
-			first = first->next;
-			event_types[evt->type].callback(evt->userdata, (int)(globalTimer - evt->time));
-			FreeEvent(evt);
-		}
-		else
-		{
-			break;
-		}
+		Event evt = PopEvent();
+		event_types[evt.type].callback(evt.userdata, (int)(globalTimer - evt.time));
 	}
 }
 
 void MoveEvents()
 {
-	BaseEvent sevt;
-	while (tsQueue.Pop(sevt))
-	{
-		Event *evt = GetNewEvent();
-		evt->time = sevt.time;
-		evt->userdata = sevt.userdata;
-		evt->type = sevt.type;
+	Event evt;
+	while (ts_queue.Pop(evt))
 		AddEventToQueue(evt);
-	}
 }
 
 void Advance()
 {
+	if (Profiler::g_ProfileCallStacks)
+		Profiler::SampleCallStack(PC);
+
 	MoveEvents();
 
 	int cyclesExecuted = slicelength - PowerPC::ppcState.downcount;
 	globalTimer += cyclesExecuted;
 	PowerPC::ppcState.downcount = slicelength;
 
-	while (first)
+	while (!event_queue.empty() && event_queue.front().time <= globalTimer)
 	{
-		if (first->time <= globalTimer)
-		{
-			//LOG(POWERPC, "[Scheduler] %s     (%lld, %lld) ",
-			//             event_types[first->type].name ? event_types[first->type].name : "?", (u64)globalTimer, (u64)first->time);
-			Event* evt = first;
-			first = first->next;
-			event_types[evt->type].callback(evt->userdata, (int)(globalTimer - evt->time));
-			FreeEvent(evt);
-		}
-		else
-		{
-			break;
-		}
+		Event evt = PopEvent();
+		//LOG(POWERPC, "[Scheduler] %s     (%lld, %lld) ",
+		//             event_types[evt.type].name ? event_types[evt.type].name : "?", (u64)globalTimer, (u64)evt.time);
+		event_types[evt.type].callback(evt.userdata, (int)(globalTimer - evt.time));
 	}
 
-	if (!first)
+	if (event_queue.empty())
 	{
 		WARN_LOG(POWERPC, "WARNING - no events in queue. Setting downcount to 10000");
 		PowerPC::ppcState.downcount += 10000;
 	}
 	else
 	{
-		slicelength = (int)(first->time - globalTimer);
+		slicelength = (int)(event_queue.front().time - globalTimer);
 		if (slicelength > maxSliceLength)
 			slicelength = maxSliceLength;
 		PowerPC::ppcState.downcount = slicelength;
@@ -427,16 +376,15 @@ void Advance()
 
 	if (advanceCallback)
 		advanceCallback(cyclesExecuted);
+
+	if (Profiler::g_ProfileCallStacks)
+		Profiler::ResumeCallStack();
 }
 
 void LogPendingEvents()
 {
-	Event *ptr = first;
-	while (ptr)
-	{
-		INFO_LOG(POWERPC, "PENDING: Now: %" PRId64 " Pending: %" PRId64 " Type: %d", globalTimer, ptr->time, ptr->type);
-		ptr = ptr->next;
-	}
+	for (const Event& ev : GetSortedEvents())
+		INFO_LOG(POWERPC, "PENDING: Now: %" PRId64 " Pending: %" PRId64 " Type: %d", globalTimer, ev.time, ev.type);
 }
 
 void Idle()
@@ -460,19 +408,17 @@ void Idle()
 
 std::string GetScheduledEventsSummary()
 {
-	Event *ptr = first;
 	std::string text = "Scheduled events\n";
 	text.reserve(1000);
-	while (ptr)
+	for (const Event& ev : GetSortedEvents())
 	{
-		unsigned int t = ptr->type;
+		unsigned int t = ev.type;
 		if (t >= event_types.size())
 			PanicAlertT("Invalid event type %i", t);
 
-		const std::string& name = event_types[ptr->type].name;
+		const std::string& name = event_types[ev.type].name;
 
-		text += StringFromFormat("%s : %" PRIi64 " %016" PRIx64 "\n", name.c_str(), ptr->time, ptr->userdata);
-		ptr = ptr->next;
+		text += StringFromFormat("%s : %" PRIi64 " %016" PRIx64 "\n", name.c_str(), ev.time, ev.userdata);
 	}
 	return text;
 }
@@ -4,6 +4,7 @@
 
 #include <cstring>
 
+#include "Common/JitRegister.h"
 #include "Core/DSP/DSPAnalyzer.h"
 #include "Core/DSP/DSPCore.h"
 #include "Core/DSP/DSPEmitter.h"
@@ -370,6 +371,8 @@ void DSPEmitter::Compile(u16 start_addr)
 		MOV(16, R(EAX), Imm16(blockSize[start_addr]));
 	}
 	JMP(returnDispatcher, true);
+
+	JitRegister::Register(entryPoint, (u32)(GetCodePtr() - entryPoint), "JIT_DSP_%04x", start_addr);
 }
 
 const u8 *DSPEmitter::CompileStub()
@@ -423,4 +426,6 @@ void DSPEmitter::CompileDispatcher()
 	//MOV(32, M(&cyclesLeft), Imm32(0));
 	ABI_PopRegistersAndAdjustStack(registers_used, 8);
 	RET();
+
+	JitRegister::Register(enterDispatcher, GetCodePtr(), "JIT_DSPDispatcher");
 }
@@ -143,14 +143,12 @@ void PPCDebugInterface::ClearAllMemChecks()
 
 bool PPCDebugInterface::IsMemCheck(unsigned int address)
 {
-	return (Memory::AreMemoryBreakpointsActivated() &&
-	        PowerPC::memchecks.GetMemCheck(address));
+	return PowerPC::memchecks.GetMemCheck(address) != nullptr;
 }
 
 void PPCDebugInterface::ToggleMemCheck(unsigned int address)
 {
-	if (Memory::AreMemoryBreakpointsActivated() &&
-	    !PowerPC::memchecks.GetMemCheck(address))
+	if (!PowerPC::memchecks.GetMemCheck(address))
 	{
 		// Add Memory Check
 		TMemCheck MemCheck;
@@ -10,6 +10,7 @@
 #include "Core/HLE/HLE.h"
 #include "Core/HLE/HLE_Misc.h"
 #include "Core/HLE/HLE_OS.h"
+#include "Core/HLE/HLE_SDK.h"
 #include "Core/HW/Memmap.h"
 #include "Core/IPC_HLE/WII_IPC_HLE_Device_es.h"
 #include "Core/PowerPC/PowerPC.h"
@@ -59,6 +60,23 @@ static const SPatch OSPatches[] =
 	{ "___blank",             HLE_OS::HLE_GeneralDebugPrint,   HLE_HOOK_REPLACE, HLE_TYPE_DEBUG },
 	{ "__write_console",      HLE_OS::HLE_write_console,       HLE_HOOK_REPLACE, HLE_TYPE_DEBUG }, // used by sysmenu (+more?)
 	{ "GeckoCodehandler",     HLE_Misc::HLEGeckoCodehandler,   HLE_HOOK_START,   HLE_TYPE_GENERIC },
+
+	// SDK functions, only used with HLE_SDK
+	{ "memcpy",               HLE_SDK::HLE_memcpy,             HLE_HOOK_REPLACE, HLE_TYPE_MEMORY },
+	{ "memset",               HLE_SDK::HLE_memset,             HLE_HOOK_REPLACE, HLE_TYPE_MEMORY },
+	{ "DCFlushRange",         HLE_SDK::HLE_DCFlushRange,       HLE_HOOK_REPLACE, HLE_TYPE_MEMORY },
+	{ "DCFlushRangeNoSync",   HLE_SDK::HLE_DCFlushRange,       HLE_HOOK_REPLACE, HLE_TYPE_MEMORY },
+	{ "DCStoreRange",         HLE_SDK::HLE_DCFlushRange,       HLE_HOOK_REPLACE, HLE_TYPE_MEMORY },
+	{ "DCStoreRangeNoSync",   HLE_SDK::HLE_DCFlushRange,       HLE_HOOK_REPLACE, HLE_TYPE_MEMORY },
+	{ "DCInvalidateRange",    HLE_SDK::HLE_DCInvalidateRange,  HLE_HOOK_REPLACE, HLE_TYPE_MEMORY },
+	{ "PSMTXIdentity",        HLE_SDK::HLE_PSMTXIdentity,      HLE_HOOK_REPLACE, HLE_TYPE_FP },
+	{ "PSMTXCopy",            HLE_SDK::HLE_PSMTXCopy,          HLE_HOOK_REPLACE, HLE_TYPE_FP },
+	{ "PSMTXConcat",          HLE_SDK::HLE_PSMTXConcat,        HLE_HOOK_REPLACE, HLE_TYPE_FP },
+	{ "PSMTXMultVec",         HLE_SDK::HLE_PSMTXMultVec,       HLE_HOOK_REPLACE, HLE_TYPE_FP },
+	{ "PSVECAdd",             HLE_SDK::HLE_PSVECAdd,           HLE_HOOK_REPLACE, HLE_TYPE_FP },
+	{ "PSVECSubtract",        HLE_SDK::HLE_PSVECSubtract,      HLE_HOOK_REPLACE, HLE_TYPE_FP },
+	{ "PSVECScale",           HLE_SDK::HLE_PSVECScale,         HLE_HOOK_REPLACE, HLE_TYPE_FP },
+	{ "PSVECDotProduct",      HLE_SDK::HLE_PSVECDotProduct,    HLE_HOOK_REPLACE, HLE_TYPE_FP },
 };
 
 static const SPatch OSBreakPoints[] =
@@ -143,7 +161,9 @@ int GetFunctionFlagsByIndex(u32 index)
 
 bool IsEnabled(int flags)
 {
-	if (flags == HLE::HLE_TYPE_MEMORY && SConfig::GetInstance().m_LocalCoreStartupParameter.bMMU)
+	// The SDK functions access memory directly, which doesn't work with the MMU.
+	if ((flags == HLE::HLE_TYPE_MEMORY || flags == HLE::HLE_TYPE_FP) &&
+	    (!SConfig::GetInstance().m_LocalCoreStartupParameter.bHLE_SDK || SConfig::GetInstance().m_LocalCoreStartupParameter.bMMU))
 		return false;
 
 	if (flags == HLE::HLE_TYPE_DEBUG && !SConfig::GetInstance().m_LocalCoreStartupParameter.bEnableDebugging && PowerPC::GetMode() != MODE_INTERPRETER)
@@ -0,0 +1,395 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <cstring>
+
+#if _M_SSE >= 0x200
+#include <emmintrin.h>
+#endif
+
+#include "Common/CommonFuncs.h"
+#include "Common/CommonTypes.h"
+#include "Common/MathUtil.h"
+
+#include "Core/HLE/HLE_SDK.h"
+#include "Core/HW/DSP.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PowerPC/JitInterface.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "Core/PowerPC/Interpreter/Interpreter_FPUtils.h"
+
+namespace HLE_SDK
+{
+
+// Returns a host pointer to [address, address + size) if all of it is in one block of memory,
+// so that it can be accessed directly.
+static u8* GetRange(u32 address, u32 size)
+{
+	u32 last = address + size - 1;
+	if (size == 0 || last < address || !Memory::IsRAMAddress(address, true) || !Memory::IsRAMAddress(last, true))
+		return nullptr;
+
+	u8* ptr = Memory::GetPointer(address);
+	if (Memory::GetPointer(last) != ptr + (size - 1))
+		return nullptr;
+	return ptr;
+}
+
+static void ReadWords(u32 address, u32* data, u32 count)
+{
+	const u8* ptr = GetRange(address, count * 4);
+	for (u32 i = 0; i < count; i++)
+		data[i] = ptr ? Common::swap32(*(const u32*)(ptr + i * 4)) : Memory::Read_U32(address + i * 4);
+}
+
+static void WriteWords(u32 address, const u32* data, u32 count)
+{
+	u8* ptr = GetRange(address, count * 4);
+	for (u32 i = 0; i < count; i++)
+	{
+		if (ptr)
+			*(u32*)(ptr + i * 4) = Common::swap32(data[i]);
+		else
+			Memory::Write_U32(data[i], address + i * 4);
+	}
+}
+
+void HLE_memcpy()
+{
+	u32 dst = GPR(3);
+	u32 src = GPR(4);
+	u32 size = GPR(5);
+
+	// The SDK's memcpy copies backwards when the destination is above the source, so
+	// overlapping copies work like memmove.
+	u8* dst_ptr = GetRange(dst, size);
+	u8* src_ptr = GetRange(src, size);
+	if (dst_ptr && src_ptr)
+	{
+		memmove(dst_ptr, src_ptr, size);
+	}
+	else if (dst > src)
+	{
+		for (u32 i = size; i > 0; i--)
+			Memory::Write_U8(Memory::Read_U8(src + i - 1), dst + i - 1);
+	}
+	else
+	{
+		for (u32 i = 0; i < size; i++)
+			Memory::Write_U8(Memory::Read_U8(src + i), dst + i);
+	}
+
+	NPC = LR;
+}
+
+void HLE_memset()
+{
+	u32 dst = GPR(3);
+	u8 value = (u8)GPR(4);
+	u32 size = GPR(5);
+
+	u8* ptr = GetRange(dst, size);
+	if (ptr)
+	{
+		memset(ptr, value, size);
+	}
+	else
+	{
+		for (u32 i = 0; i < size; i++)
+			Memory::Write_U8(value, dst + i);
+	}
+
+	NPC = LR;
+}
+
+// The size of the cache lines that [address, address + size) touches.
+static u32 CacheLineRange(u32 address, u32 size)
+{
+	return ((address & 31) + size + 31) & ~31;
+}
+
+// Also used for DCStoreRange, and the NoSync versions of both.
+void HLE_DCFlushRange()
+{
+	u32 address = GPR(3);
+	u32 size = GPR(4);
+
+	// The data cache isn't emulated, so all that's left of the dcbf or dcbst loop is
+	// invalidating the JIT's blocks, in case this was code.
+	if (size != 0)
+		JitInterface::InvalidateICache(address & ~31, CacheLineRange(address, size), false);
+
+	NPC = LR;
+}
+
+void HLE_DCInvalidateRange()
+{
+	u32 address = GPR(3);
+	u32 size = GPR(4);
+
+	if (size != 0)
+	{
+		u32 first = address & ~31;
+		u32 range = CacheLineRange(address, size);
+		JitInterface::InvalidateICache(first, range, false);
+
+		// The same check as Interpreter::dcbi does for each line, for the whole range.
+		u64 dma_in_progress = DSP::DMAInProgress();
+		if (dma_in_progress != 0)
+		{
+			u32 start_addr = (dma_in_progress >> 32) & Memory::RAM_MASK;
+			u32 end_addr = (dma_in_progress & Memory::RAM_MASK) & 0xffffffff;
+			u32 first_line = first & Memory::RAM_MASK;
+			u32 last_line = first_line + range - 32;
+			// The first line that isn't before the DMA.
+			u32 line = first_line >= start_addr ? first_line : first_line + ((start_addr - first_line + 31) & ~31);
+
+			if (line <= last_line && line <= end_addr)
+				DSP::EnableInstantDMA();
+		}
+	}
+
+	NPC = LR;
+}
+
+// One paired single register, as the interpreter keeps it: two doubles, each of which holds
+// a single precision value. The operations below round their results to single precision
+// like the paired single instructions they are named after, and the stores flush denormals
+// to zero like psq_st does.
+#if _M_SSE >= 0x200
+
+typedef __m128d Pair;
+
+static inline Pair LoadPair(const u32* data)
+{
+	return _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64((const __m128i*)data)));
+}
+
+// psq_l with W set, which loads 1.0 into ps1.
+static inline Pair LoadSingle(const u32* data)
+{
+	return _mm_cvtps_pd(_mm_castsi128_ps(_mm_setr_epi32(*data, 0x3F800000, 0, 0)));
+}
+
+static inline __m128i ToSingles(Pair p)
+{
+	__m128i singles = _mm_castps_si128(_mm_cvtpd_ps(p));
+	__m128i denormal = _mm_cmpeq_epi32(_mm_and_si128(singles, _mm_set1_epi32(0x7F800000)), _mm_setzero_si128());
+	return _mm_andnot_si128(_mm_and_si128(denormal, _mm_set1_epi32(0x7FFFFFFF)), singles);
+}
+
+static inline void StorePair(u32* data, Pair p)
+{
+	_mm_storel_epi64((__m128i*)data, ToSingles(p));
+}
+
+static inline void StoreSingle(u32* data, Pair p)
+{
+	*data = _mm_cvtsi128_si32(ToSingles(p));
+}
+
+static inline Pair GetFPR(int reg)
+{
+	return _mm_loadu_pd((const double*)PowerPC::ppcState.ps[reg]);
+}
+
+static inline void SetFPR(int reg, Pair p)
+{
+	_mm_storeu_pd((double*)PowerPC::ppcState.ps[reg], p);
+}
+
+static inline Pair Round(Pair p)
+{
+	return _mm_cvtps_pd(_mm_cvtpd_ps(p));
+}
+
+static inline Pair ps_add(Pair a, Pair b) { return Round(_mm_add_pd(a, b)); }
+static inline Pair ps_sub(Pair a, Pair b) { return Round(_mm_sub_pd(a, b)); }
+static inline Pair ps_mul(Pair a, Pair c) { return Round(_mm_mul_pd(a, c)); }
+static inline Pair ps_madd(Pair a, Pair c, Pair b) { return Round(_mm_add_pd(_mm_mul_pd(a, c), b)); }
+static inline Pair ps_muls0(Pair a, Pair c) { return ps_mul(a, _mm_unpacklo_pd(c, c)); }
+static inline Pair ps_madds0(Pair a, Pair c, Pair b) { return ps_madd(a, _mm_unpacklo_pd(c, c), b); }
+static inline Pair ps_madds1(Pair a, Pair c, Pair b) { return ps_madd(a, _mm_unpackhi_pd(c, c), b); }
+
+// ps0 = a.ps0 + b.ps1, ps1 = c.ps1
+static inline Pair ps_sum0(Pair a, Pair c, Pair b)
+{
+	return Round(_mm_shuffle_pd(_mm_add_sd(a, _mm_unpackhi_pd(b, b)), c, 2));
+}
+
+#else
+
+struct Pair
+{
+	double ps0, ps1;
+};
+
+static inline double WordToDouble(u32 data)
+{
+	return MathUtil::IntFloat(data).f;
+}
+
+static inline u32 DoubleToWord(double value)
+{
+	u32 single = MathUtil::IntFloat((float)value).i;
+	return (single & 0x7F800000) ? single : (single & 0x80000000);
+}
+
+static inline Pair LoadPair(const u32* data) { return { WordToDouble(data[0]), WordToDouble(data[1]) }; }
+static inline Pair LoadSingle(const u32* data) { return { WordToDouble(data[0]), 1.0 }; }
+static inline void StorePair(u32* data, Pair p) { data[0] = DoubleToWord(p.ps0); data[1] = DoubleToWord(p.ps1); }
+static inline void StoreSingle(u32* data, Pair p) { data[0] = DoubleToWord(p.ps0); }
+static inline Pair GetFPR(int reg) { return { rPS0(reg), rPS1(reg) }; }
+static inline void SetFPR(int reg, Pair p) { rPS0(reg) = p.ps0; rPS1(reg) = p.ps1; }
+static inline Pair Round(Pair p) { return { (float)p.ps0, (float)p.ps1 }; }
+
+static inline Pair ps_add(Pair a, Pair b) { return Round({ a.ps0 + b.ps0, a.ps1 + b.ps1 }); }
+static inline Pair ps_sub(Pair a, Pair b) { return Round({ a.ps0 - b.ps0, a.ps1 - b.ps1 }); }
+static inline Pair ps_mul(Pair a, Pair c) { return Round({ a.ps0 * c.ps0, a.ps1 * c.ps1 }); }
+static inline Pair ps_madd(Pair a, Pair c, Pair b) { return Round({ a.ps0 * c.ps0 + b.ps0, a.ps1 * c.ps1 + b.ps1 }); }
+static inline Pair ps_muls0(Pair a, Pair c) { return ps_mul(a, { c.ps0, c.ps0 }); }
+static inline Pair ps_madds0(Pair a, Pair c, Pair b) { return ps_madd(a, { c.ps0, c.ps0 }, b); }
+static inline Pair ps_madds1(Pair a, Pair c, Pair b) { return ps_madd(a, { c.ps1, c.ps1 }, b); }
+static inline Pair ps_sum0(Pair a, Pair c, Pair b) { return Round({ a.ps0 + b.ps1, c.ps1 }); }
+
+#endif
+
+void HLE_PSMTXIdentity()
+{
+	static const u32 identity[12] = {
+		0x3F800000, 0, 0, 0,
+		0, 0x3F800000, 0, 0,
+		0, 0, 0x3F800000, 0,
+	};
+	WriteWords(GPR(3), identity, 12);
+
+	NPC = LR;
+}
+
+void HLE_PSMTXCopy()
+{
+	// Goes through psq_l and psq_st, so denormals don't survive.
+	u32 m[12];
+	ReadWords(GPR(3), m, 12);
+	for (int i = 0; i < 12; i += 2)
+		StorePair(&m[i], LoadPair(&m[i]));
+	WriteWords(GPR(4), m, 12);
+
+	NPC = LR;
+}
+
+void HLE_PSMTXConcat()
+{
+	// Everything is read before anything is written, which is what the SDK ends up doing
+	// when the destination is one of the sources.
+	u32 a[12], b[12], ab[12];
+	ReadWords(GPR(3), a, 12);
+	ReadWords(GPR(4), b, 12);
+
+	static const u32 unit01[2] = { 0, 0x3F800000 };
+	const Pair unit = LoadPair(unit01);
+
+	for (int i = 0; i < 12; i += 4)
+	{
+		Pair a01 = LoadPair(&a[i]);
+		Pair a23 = LoadPair(&a[i + 2]);
+
+		Pair ab01 = ps_muls0(LoadPair(&b[0]), a01);
+		ab01 = ps_madds1(LoadPair(&b[4]), a01, ab01);
+		ab01 = ps_madds0(LoadPair(&b[8]), a23, ab01);
+
+		Pair ab23 = ps_muls0(LoadPair(&b[2]), a01);
+		ab23 = ps_madds1(LoadPair(&b[6]), a01, ab23);
+		ab23 = ps_madds0(LoadPair(&b[10]), a23, ab23);
+		// Adds the translation in ps1, and 0 in ps0.
+		ab23 = ps_madds1(unit, a23, ab23);
+
+		StorePair(&ab[i], ab01);
+		StorePair(&ab[i + 2], ab23);
+	}
+	WriteWords(GPR(5), ab, 12);
+
+	NPC = LR;
+}
+
+void HLE_PSMTXMultVec()
+{
+	u32 m[12], v[3], mv[3];
+	ReadWords(GPR(3), m, 12);
+	ReadWords(GPR(4), v, 3);
+
+	Pair xy = LoadPair(&v[0]);
+	Pair z1 = LoadSingle(&v[2]);
+	for (int i = 0; i < 3; i++)
+	{
+		Pair p = ps_mul(LoadPair(&m[i * 4]), xy);
+		p = ps_madd(LoadPair(&m[i * 4 + 2]), z1, p);
+		StoreSingle(&mv[i], ps_sum0(p, p, p));
+	}
+	WriteWords(GPR(5), mv, 3);
+
+	NPC = LR;
+}
+
+void HLE_PSVECAdd()
+{
+	u32 a[3], b[3], ab[3];
+	ReadWords(GPR(3), a, 3);
+	ReadWords(GPR(4), b, 3);
+
+	StorePair(&ab[0], ps_add(LoadPair(&a[0]), LoadPair(&b[0])));
+	StoreSingle(&ab[2], ps_add(LoadSingle(&a[2]), LoadSingle(&b[2])));
+	WriteWords(GPR(5), ab, 3);
+
+	NPC = LR;
+}
+
+void HLE_PSVECSubtract()
+{
+	u32 a[3], b[3], ab[3];
+	ReadWords(GPR(3), a, 3);
+	ReadWords(GPR(4), b, 3);
+
+	StorePair(&ab[0], ps_sub(LoadPair(&a[0]), LoadPair(&b[0])));
+	StoreSingle(&ab[2], ps_sub(LoadSingle(&a[2]), LoadSingle(&b[2])));
+	WriteWords(GPR(5), ab, 3);
+
+	NPC = LR;
+}
+
+void HLE_PSVECScale()
+{
+	u32 v[3], scaled[3];
+	ReadWords(GPR(3), v, 3);
+
+	// The scale is in f1, which might not have been rounded to single precision; the
+	// instructions only use 25 bits of the mantissa of their C operand.
+	Pair scale = GetFPR(1);
+#if _M_SSE >= 0x200
+	scale = _mm_set1_pd(Force25Bit(_mm_cvtsd_f64(scale)));
+#else
+	scale.ps0 = Force25Bit(scale.ps0);
+#endif
+
+	StorePair(&scaled[0], ps_muls0(LoadPair(&v[0]), scale));
+	StoreSingle(&scaled[2], ps_muls0(LoadSingle(&v[2]), scale));
+	WriteWords(GPR(4), scaled, 3);
+
+	NPC = LR;
+}
+
+void HLE_PSVECDotProduct()
+{
+	u32 a[3], b[3];
+	ReadWords(GPR(3), a, 3);
+	ReadWords(GPR(4), b, 3);
+
+	Pair yz = ps_mul(LoadPair(&a[1]), LoadPair(&b[1]));
+	Pair xy = ps_madd(LoadPair(&a[0]), LoadPair(&b[0]), yz);
+	SetFPR(1, ps_sum0(xy, yz, yz));
+
+	NPC = LR;
+}
+
+}
@@ -0,0 +1,29 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "Common/CommonTypes.h"
+
+// Host implementations of SDK functions that games spend a lot of time in. They are only
+// hooked when HLE_SDK is enabled, since they skip side effects that the originals have on
+// FPSCR and the volatile registers.
+namespace HLE_SDK
+{
+	void HLE_memcpy();
+	void HLE_memset();
+	void HLE_DCFlushRange();
+	void HLE_DCInvalidateRange();
+
+	// These do the same arithmetic as the SDK's paired single code, in the same order,
+	// so that the results are bit for bit the same.
+	void HLE_PSMTXIdentity();
+	void HLE_PSMTXCopy();
+	void HLE_PSMTXConcat();
+	void HLE_PSMTXMultVec();
+	void HLE_PSVECAdd();
+	void HLE_PSVECSubtract();
+	void HLE_PSVECScale();
+	void HLE_PSVECDotProduct();
+}
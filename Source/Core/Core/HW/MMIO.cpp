@@ -2,6 +2,7 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <functional>
 
 #include "Core/HW/MMIO.h"
@@ -219,17 +220,83 @@ template <typename T> struct LargerAccessSize {};
 template <> struct LargerAccessSize<u8> { typedef u16 value; };
 template <> struct LargerAccessSize<u16> { typedef u32 value; };
 
+// Visitors that record which handling method a handler uses, so that the
+// converters can combine simple handlers into a simple handler of the new size
+// instead of a lambda. That matters most for the JIT, which can only inline
+// constant and direct accesses.
+template <typename T>
+struct ReadMethodInspector : public ReadHandlingMethodVisitor<T>
+{
+	enum { CONSTANT, DIRECT, COMPLEX } kind;
+	T value;
+	const T* addr;
+	u32 mask;
+
+	virtual void VisitConstant(T v)
+	{
+		kind = CONSTANT;
+		value = v;
+	}
+	virtual void VisitDirect(const T* a, u32 m)
+	{
+		kind = DIRECT;
+		addr = a;
+		mask = m;
+	}
+	virtual void VisitComplex(const std::function<T(u32)>* lambda)
+	{
+		kind = COMPLEX;
+	}
+};
+template <typename T>
+struct WriteMethodInspector : public WriteHandlingMethodVisitor<T>
+{
+	enum { NOP, DIRECT, COMPLEX } kind;
+	T* addr;
+	u32 mask;
+
+	virtual void VisitNop()
+	{
+		kind = NOP;
+	}
+	virtual void VisitDirect(T* a, u32 m)
+	{
+		kind = DIRECT;
+		addr = a;
+		mask = m;
+	}
+	virtual void VisitComplex(const std::function<void(u32, T)>* lambda)
+	{
+		kind = COMPLEX;
+	}
+};
+
+// The combined handlers are built from the ones registered at the time of the
+// call, so register the smaller or larger handlers first.
+//
+// Two direct halves can only become one direct access if they are next to each
+// other in host memory, with the high part at the higher address since the
+// host is little endian.
 template <typename T>
 ReadHandlingMethod<T>* ReadToSmaller(Mapping* mmio, u32 high_part_addr, u32 low_part_addr)
 {
 	typedef typename SmallerAccessSize<T>::value ST;
+	const u32 shift = 8 * sizeof (ST);
+	const u32 part_mask = (ST)~0;
 
 	ReadHandler<ST>* high_part = &mmio->GetHandlerForRead<ST>(high_part_addr);
 	ReadHandler<ST>* low_part = &mmio->GetHandlerForRead<ST>(low_part_addr);
 
-	// TODO(delroth): optimize
+	ReadMethodInspector<ST> high, low;
+	high_part->Visit(high);
+	low_part->Visit(low);
+	if (high.kind == high.CONSTANT && low.kind == low.CONSTANT)
+		return Constant<T>(((T)high.value << shift) | low.value);
+	if (high.kind == high.DIRECT && low.kind == low.DIRECT && high.addr == low.addr + 1)
+		return DirectRead<T>((const T*)low.addr, ((high.mask & part_mask) << shift) | (low.mask & part_mask));
+
 	return ComplexRead<T>([=](u32 addr) {
-		return ((T)high_part->Read(high_part_addr) << (8 * sizeof (ST)))
+		return ((T)high_part->Read(high_part_addr) << shift)
 			| low_part->Read(low_part_addr);
 	});
 }
@@ -238,13 +305,22 @@ template <typename T>
 WriteHandlingMethod<T>* WriteToSmaller(Mapping* mmio, u32 high_part_addr, u32 low_part_addr)
 {
 	typedef typename SmallerAccessSize<T>::value ST;
+	const u32 shift = 8 * sizeof (ST);
+	const u32 part_mask = (ST)~0;
 
 	WriteHandler<ST>* high_part = &mmio->GetHandlerForWrite<ST>(high_part_addr);
 	WriteHandler<ST>* low_part = &mmio->GetHandlerForWrite<ST>(low_part_addr);
 
-	// TODO(delroth): optimize
+	WriteMethodInspector<ST> high, low;
+	high_part->Visit(high);
+	low_part->Visit(low);
+	if (high.kind == high.NOP && low.kind == low.NOP)
+		return Nop<T>();
+	if (high.kind == high.DIRECT && low.kind == low.DIRECT && high.addr == low.addr + 1)
+		return DirectWrite<T>((T*)low.addr, ((high.mask & part_mask) << shift) | (low.mask & part_mask));
+
 	return ComplexWrite<T>([=](u32 addr, T val) {
-		high_part->Write(high_part_addr, val >> (8 * sizeof (ST)));
+		high_part->Write(high_part_addr, val >> shift);
 		low_part->Write(low_part_addr, (ST)val);
 	});
 }
@@ -256,7 +332,13 @@ ReadHandlingMethod<T>* ReadToLarger(Mapping* mmio, u32 larger_addr, u32 shift)
 
 	ReadHandler<LT>* large = &mmio->GetHandlerForRead<LT>(larger_addr);
 
-	// TODO(delroth): optimize
+	ReadMethodInspector<LT> method;
+	large->Visit(method);
+	if (method.kind == method.CONSTANT)
+		return Constant<T>((T)(method.value >> shift));
+	if (method.kind == method.DIRECT)
+		return DirectRead<T>((const T*)((const u8*)method.addr + shift / 8), (method.mask >> shift) & (T)~0);
+
 	return ComplexRead<T>([large, shift](u32 addr) {
 		return large->Read(addr & ~(sizeof (LT) - 1)) >> shift;
 	});
@@ -377,6 +459,34 @@ void WriteHandler<T>::ResetMethod(WriteHandlingMethod<T>* method)
 	m_WriteFunc = v.ret;
 }
 
+void Mapping::EnableAccessCounting()
+{
+	if (!m_access_counts)
+		m_access_counts.reset(new AccessCounts());
+}
+
+std::vector<Mapping::AccessCount> Mapping::GetAccessCounts() const
+{
+	std::vector<AccessCount> counts;
+	if (!m_access_counts)
+		return counts;
+
+	for (u32 id = 0; id < NUM_MMIOS; ++id)
+	{
+		u64 reads = m_access_counts->reads[id];
+		u64 writes = m_access_counts->writes[id];
+		if (reads || writes)
+		{
+			u32 address = ((id >> 16) ? 0xCD000000 : 0xCC000000) | (id & 0xFFFF);
+			counts.push_back({address, reads, writes});
+		}
+	}
+	std::stable_sort(counts.begin(), counts.end(), [](const AccessCount& a, const AccessCount& b) {
+		return a.reads + a.writes > b.reads + b.writes;
+	});
+	return counts;
+}
+
 // Define all the public specializations that are exported in MMIOHandlers.h.
 #define MaybeExtern
 MMIO_PUBLIC_SPECIALIZATIONS()
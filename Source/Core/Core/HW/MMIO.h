@@ -5,8 +5,10 @@
 #pragma once
 
 #include <array>
+#include <memory>
 #include <string>
 #include <type_traits>
+#include <vector>
 
 #include "Common/Common.h"
 #include "Core/HW/MMIOHandlers.h"
@@ -103,15 +105,42 @@ public:
 	template<typename Unit>
 	Unit Read(u32 addr)
 	{
+		if (m_access_counts)
+			m_access_counts->reads[UniqueID(addr)]++;
 		return GetHandlerForRead<Unit>(addr).Read(addr);
 	}
 
 	template<typename Unit>
 	void Write(u32 addr, Unit val)
 	{
+		if (m_access_counts)
+			m_access_counts->writes[UniqueID(addr)]++;
 		GetHandlerForWrite<Unit>(addr).Write(addr, val);
 	}
 
+	// Access counting interface.
+	//
+	// Counts the reads and writes of every register, to find out which ones a
+	// game spends its time polling. Accesses are counted at the address they
+	// start at, whatever their size. The JIT only counts in code it compiles
+	// while counting is enabled, so enable it before running anything.
+	struct AccessCount
+	{
+		u32 address;
+		u64 reads;
+		u64 writes;
+	};
+
+	void EnableAccessCounting();
+	bool IsCountingAccesses() const { return m_access_counts != nullptr; }
+
+	// Only valid while counting. The JIT increments these directly.
+	u64* GetReadCounter(u32 addr) { return &m_access_counts->reads[UniqueID(addr)]; }
+	u64* GetWriteCounter(u32 addr) { return &m_access_counts->writes[UniqueID(addr)]; }
+
+	// Returns the registers that have been accessed, most accessed first.
+	std::vector<AccessCount> GetAccessCounts() const;
+
 	// Handlers access interface.
 	//
 	// Use when you care more about how to access the MMIO register for an
@@ -153,6 +182,15 @@ private:
 	HandlerArray<u16>::Write m_write_handlers16;
 	HandlerArray<u32>::Write m_write_handlers32;
 
+	// Indexed by UniqueID(addr). Only allocated while counting, since it is
+	// a few megabytes.
+	struct AccessCounts
+	{
+		std::array<u64, NUM_MMIOS> reads;
+		std::array<u64, NUM_MMIOS> writes;
+	};
+	std::unique_ptr<AccessCounts> m_access_counts;
+
 	// Getter functions for the handler arrays.
 	//
 	// TODO:
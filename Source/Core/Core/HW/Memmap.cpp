@@ -8,13 +8,21 @@
 // However, if a JITed instruction (for example lwz) wants to access a bad memory area that call
 // may be redirected here (for example to Read_U32()).
 
+#include <algorithm>
+#include <cinttypes>
+#include <map>
+#include <string>
+#include <vector>
+
 #include "Common/ChunkFile.h"
 #include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
 #include "Common/MemArena.h"
 #include "Common/MemoryUtil.h"
 
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
+#include "Core/MemTools.h"
 #include "Core/Debugger/Debugger_SymbolMap.h"
 #include "Core/HLE/HLE.h"
 #include "Core/HW/AudioInterface.h"
@@ -63,6 +71,9 @@ static MemArena g_arena;
 static bool m_IsInitialized = false; // Save the Init(), Shutdown() state
 // END STATE_TO_SAVE
 
+// Host pages currently protected for memchecks.
+static std::vector<u8*> s_memcheck_pages;
+
 u8* m_pRAM;
 u8* m_pL1Cache;
 u8* m_pEXRAM;
@@ -96,6 +107,46 @@ static void InitMMIOWii(MMIO::Mapping* mmio)
 	AudioInterface::RegisterMMIO(mmio, 0xCD006C00);
 }
 
+// Which device a register belongs to, for the access counts.
+static const char* MMIODeviceName(u32 address)
+{
+	u32 offset = address & 0xFFFF;
+	if ((address & 0xFF000000) == 0xCD000000 && offset < 0x1000)
+		return "IPC";
+	if (offset < 0x1000) return "CP";
+	if (offset < 0x2000) return "PE";
+	if (offset < 0x3000) return "VI";
+	if (offset < 0x4000) return "PI";
+	if (offset < 0x5000) return "MI";
+	if (offset < 0x6000) return "DSP";
+	if (offset < 0x6400) return "DI";
+	if (offset < 0x6800) return "SI";
+	if (offset < 0x6C00) return "EXI";
+	if (offset < 0x7000) return "AI";
+	return "?";
+}
+
+static void WriteMMIOAccessCounts(MMIO::Mapping* mmio)
+{
+	std::string filename = File::GetUserPath(D_DUMP_IDX) + "Debug/mmio-" +
+	                       SConfig::GetInstance().m_LocalCoreStartupParameter.GetUniqueID() + ".txt";
+	File::CreateFullPath(filename);
+	File::IOFile f(filename, "w");
+	if (!f)
+	{
+		PanicAlert("Failed to open %s", filename.c_str());
+		return;
+	}
+
+	fprintf(f.GetHandle(), "address\tdevice\treads\twrites\n");
+	for (const auto& count : mmio->GetAccessCounts())
+	{
+		fprintf(f.GetHandle(), "%08x\t%s\t%" PRIu64 "\t%" PRIu64 "\n",
+		        count.address, MMIODeviceName(count.address), count.reads, count.writes);
+	}
+	NOTICE_LOG(MEMMAP, "MMIO access counts written to %s", filename.c_str());
+}
+
 bool IsInitialized()
 {
 	return m_IsInitialized;
@@ -138,8 +189,14 @@ void Init()
 	else
 		InitMMIO(mmio_mapping);
 
+	if (SConfig::GetInstance().m_LocalCoreStartupParameter.bProfileMMIO)
+		mmio_mapping->EnableAccessCounting();
+
 	INFO_LOG(MEMMAP, "Memory system initialized. RAM at %p", m_pRAM);
 	m_IsInitialized = true;
+
+	// The memchecks outlive the views.
+	UpdateMemCheckProtection();
 }
 
 void DoState(PointerWrap &p)
@@ -162,9 +219,12 @@ void Shutdown()
 	u32 flags = 0;
 	if (SConfig::GetInstance().m_LocalCoreStartupParameter.bWii) flags |= MV_WII_ONLY;
 	if (bFakeVMEM) flags |= MV_FAKE_VMEM;
+	s_memcheck_pages.clear();
 	MemoryMap_Shutdown(views, num_views, flags, &g_arena);
 	g_arena.ReleaseSHMSegment();
 	base = nullptr;
+	if (mmio_mapping->IsCountingAccesses())
+		WriteMMIOAccessCounts(mmio_mapping);
 	delete mmio_mapping;
 	INFO_LOG(MEMMAP, "Memory system shut down.");
 }
@@ -179,12 +239,51 @@ void Clear()
 		memset(m_pEXRAM, 0, EXRAM_SIZE);
 }
 
-bool AreMemoryBreakpointsActivated()
+void UpdateMemCheckProtection()
 {
-#ifndef ENABLE_MEM_CHECK
-	return false;
-#else
-	return true;
+	const int page_size = GetPageSize();
+	for (u8* page : s_memcheck_pages)
+		UnWriteProtectMemory(page, page_size);
+	s_memcheck_pages.clear();
+
+#if _M_X86_64
+	// Only the fastmem loads and stores can be backpatched when they fault,
+	// the rest of the JIT expects RAM to be accessible. Everything outside of
+	// the JIT goes through m_pRAM and m_pEXRAM, so only the mirrors are
+	// protected; accesses through those to a watched page take the slow path.
+	const SCoreStartupParameter& params = SConfig::GetInstance().m_LocalCoreStartupParameter;
+	if (!m_IsInitialized || bMMU || !params.bFastmem || !EMM::g_exception_handlers_supported)
+		return;
+
+	// Guest page -> whether reads are watched too
+	std::map<u32, bool> pages;
+	for (const TMemCheck& mc : PowerPC::memchecks.GetMemChecks())
+	{
+		if (!mc.OnRead && !mc.OnWrite)
+			continue;
+
+		u32 end_address = mc.bRange ? mc.EndAddress : mc.StartAddress;
+		for (const MemoryView& view : views)
+		{
+			if (!view.mapped_ptr || !(view.flags & MV_MIRROR_PREVIOUS))
+				continue;
+
+			u32 start = std::max(mc.StartAddress, view.virtual_address);
+			u32 end = std::min(end_address, view.virtual_address + view.size - 1);
+			for (u64 page = start & ~(page_size - 1); page <= end; page += page_size)
+				pages[(u32)page] |= mc.OnRead;
+		}
+	}
+
+	for (const auto& page : pages)
+	{
+		u8* ptr = base + page.first;
+		if (page.second)
+			ReadProtectMemory(ptr, page_size);
+		else
+			WriteProtectMemory(ptr, page_size);
+		s_memcheck_pages.push_back(ptr);
+	}
 #endif
 }
 
@@ -9,11 +9,6 @@
 #include "Common/CommonFuncs.h"
 #include "Common/CommonTypes.h"
 
-// Enable memory checks in the Debug/DebugFast builds, but NOT in release
-#if defined(_DEBUG) || defined(DEBUGFAST)
-	#define ENABLE_MEM_CHECK
-#endif
-
 // Global declarations
 class PointerWrap;
 namespace MMIO { class Mapping; }
@@ -71,7 +66,11 @@ void Shutdown();
 void DoState(PointerWrap &p);
 
 void Clear();
-bool AreMemoryBreakpointsActivated();
+
+// Protects the host pages that back the addresses watched by memchecks in the
+// mirrors fastmem accesses go through, so JIT code faults and gets backpatched
+// into a call to the Read_*/Write_* functions, which do the checking.
+void UpdateMemCheckProtection();
 
 // ONLY for use by GUI
 u8 ReadUnchecked_U8(const u32 _Address);
@@ -137,6 +136,28 @@ enum XCheckTLBFlag
 };
 u32 TranslateAddress(u32 _Address, XCheckTLBFlag _Flag);
 void InvalidateTLBEntry(u32 _Address);
+
+// Direct-mapped cache of the data translations the MMU path got from the page
+// table, indexed by effective page. Each entry is a subset of the emulated TLB
+// and only maps to RAM or EXRAM, so a hit can go straight to base + physical
+// address. Jit64 checks it inline before calling the Read_*/Write_* functions.
+struct SoftTLBEntry
+{
+	u32 tag;    // effective page address, or SOFT_TLB_INVALID_TAG
+	u32 offset; // added to the effective address to get the physical one
+};
+enum
+{
+	SOFT_TLB_SIZE = 1024,
+	SOFT_TLB_MASK = SOFT_TLB_SIZE - 1,
+	SOFT_TLB_INVALID_TAG = 1,
+};
+extern SoftTLBEntry soft_tlb_read[SOFT_TLB_SIZE];
+extern SoftTLBEntry soft_tlb_write[SOFT_TLB_SIZE];
+// Has to be called whenever translations can change other than through tlbie:
+// segment registers, SDR1 and BATs.
+void FlushSoftTLB();
+
 extern u32 pagetable_base;
 extern u32 pagetable_hashmask;
 }
@@ -88,6 +88,19 @@ static u32 EFB_Read(const u32 addr)
 }
 
 static void GenerateDSIException(u32 _EffectiveAddress, bool _bWrite);
+static void UpdateSoftTLB(SoftTLBEntry* table, u32 em_address, u32 paddr);
+
+SoftTLBEntry soft_tlb_read[SOFT_TLB_SIZE];
+SoftTLBEntry soft_tlb_write[SOFT_TLB_SIZE];
+
+// Returns 0 on a miss, like TranslateAddress() does for an untranslatable address.
+static inline u32 LookupSoftTLB(const SoftTLBEntry* table, u32 em_address)
+{
+	const SoftTLBEntry& entry = table[(em_address >> HW_PAGE_INDEX_SHIFT) & SOFT_TLB_MASK];
+	if (entry.tag != (em_address & ~(HW_PAGE_SIZE - 1)))
+		return 0;
+	return em_address + entry.offset;
+}
 
 template <typename T>
 inline void ReadFromHardware(T &_var, const u32 em_address, Memory::XCheckTLBFlag flag)
@@ -169,7 +182,15 @@ inline void ReadFromHardware(T &_var, const u32 em_address, Memory::XCheckTLBFla
 		}
 		else
 		{
-			u32 tlb_addr = TranslateAddress(em_address, flag);
+			u32 tlb_addr = 0;
+			if (flag == FLAG_READ)
+				tlb_addr = LookupSoftTLB(soft_tlb_read, em_address);
+			if (tlb_addr == 0)
+			{
+				tlb_addr = TranslateAddress(em_address, flag);
+				if (tlb_addr != 0 && flag == FLAG_READ)
+					UpdateSoftTLB(soft_tlb_read, em_address, tlb_addr);
+			}
 			if (tlb_addr == 0)
 			{
 				if (flag == FLAG_READ)
@@ -302,7 +323,17 @@ inline void WriteToHardware(u32 em_address, const T data, Memory::XCheckTLBFlag
 		}
 		else
 		{
-			u32 tlb_addr = TranslateAddress(em_address, flag);
+			u32 tlb_addr = 0;
+			if (flag == FLAG_WRITE)
+				tlb_addr = LookupSoftTLB(soft_tlb_write, em_address);
+			if (tlb_addr == 0)
+			{
+				// A successful write translation has set the changed bit, so
+				// later writes to the page don't have to go through the TLB.
+				tlb_addr = TranslateAddress(em_address, flag);
+				if (tlb_addr != 0 && flag == FLAG_WRITE)
+					UpdateSoftTLB(soft_tlb_write, em_address, tlb_addr);
+			}
 			if (tlb_addr == 0)
 			{
 				if (flag == FLAG_WRITE)
@@ -365,18 +396,24 @@ u32 Read_Opcode(u32 _Address)
 	return PowerPC::ppcState.iCache.ReadInstruction(_Address);
 }
 
-u8 Read_U8(const u32 _Address)
+static inline void MemCheck(u32 address, u32 value, bool write, int size)
 {
-	u8 _var = 0;
-	ReadFromHardware<u8>(_var, _Address, FLAG_READ);
-#ifdef ENABLE_MEM_CHECK
-	TMemCheck *mc = PowerPC::memchecks.GetMemCheck(_Address);
+	if (!PowerPC::memchecks.HasAny())
+		return;
+
+	TMemCheck *mc = PowerPC::memchecks.GetMemCheck(address);
 	if (mc)
 	{
 		mc->numHits++;
-		mc->Action(&PowerPC::debug_interface, _var, _Address, false, 1, PC);
+		mc->Action(&PowerPC::debug_interface, value, address, write, size, PC);
 	}
-#endif
+}
+
+u8 Read_U8(const u32 _Address)
+{
+	u8 _var = 0;
+	ReadFromHardware<u8>(_var, _Address, FLAG_READ);
+	MemCheck(_Address, _var, false, 1);
 	return (u8)_var;
 }
 
@@ -384,14 +421,7 @@ u16 Read_U16(const u32 _Address)
 {
 	u16 _var = 0;
 	ReadFromHardware<u16>(_var, _Address, FLAG_READ);
-#ifdef ENABLE_MEM_CHECK
-	TMemCheck *mc = PowerPC::memchecks.GetMemCheck(_Address);
-	if (mc)
-	{
-		mc->numHits++;
-		mc->Action(&PowerPC::debug_interface, _var, _Address, false, 2, PC);
-	}
-#endif
+	MemCheck(_Address, _var, false, 2);
 	return (u16)_var;
 }
 
@@ -399,14 +429,7 @@ u32 Read_U32(const u32 _Address)
 {
 	u32 _var = 0;
 	ReadFromHardware<u32>(_var, _Address, FLAG_READ);
-#ifdef ENABLE_MEM_CHECK
-	TMemCheck *mc = PowerPC::memchecks.GetMemCheck(_Address);
-	if (mc)
-	{
-		mc->numHits++;
-		mc->Action(&PowerPC::debug_interface, _var, _Address, false, 4, PC);
-	}
-#endif
+	MemCheck(_Address, _var, false, 4);
 	return _var;
 }
 
@@ -414,14 +437,7 @@ u64 Read_U64(const u32 _Address)
 {
 	u64 _var = 0;
 	ReadFromHardware<u64>(_var, _Address, FLAG_READ);
-#ifdef ENABLE_MEM_CHECK
-	TMemCheck *mc = PowerPC::memchecks.GetMemCheck(_Address);
-	if (mc)
-	{
-		mc->numHits++;
-		mc->Action(&PowerPC::debug_interface, (u32)_var, _Address, false, 8, PC);
-	}
-#endif
+	MemCheck(_Address, (u32)_var, false, 8);
 	return _var;
 }
 
@@ -461,28 +477,14 @@ u32 Read_U16_ZX(const u32 _Address)
 
 void Write_U8(const u8 _Data, const u32 _Address)
 {
-#ifdef ENABLE_MEM_CHECK
-	TMemCheck *mc = PowerPC::memchecks.GetMemCheck(_Address);
-	if (mc)
-	{
-		mc->numHits++;
-		mc->Action(&PowerPC::debug_interface, _Data,_Address,true,1,PC);
-	}
-#endif
+	MemCheck(_Address, _Data, true, 1);
 	WriteToHardware<u8>(_Address, _Data, FLAG_WRITE);
 }
 
 
 void Write_U16(const u16 _Data, const u32 _Address)
 {
-#ifdef ENABLE_MEM_CHECK
-	TMemCheck *mc = PowerPC::memchecks.GetMemCheck(_Address);
-	if (mc)
-	{
-		mc->numHits++;
-		mc->Action(&PowerPC::debug_interface, _Data,_Address,true,2,PC);
-	}
-#endif
+	MemCheck(_Address, _Data, true, 2);
 
 	WriteToHardware<u16>(_Address, _Data, FLAG_WRITE);
 }
@@ -494,14 +496,7 @@ void Write_U16_Swap(const u16 _Data, const u32 _Address)
 
 void Write_U32(const u32 _Data, const u32 _Address)
 {
-#ifdef ENABLE_MEM_CHECK
-	TMemCheck *mc = PowerPC::memchecks.GetMemCheck(_Address);
-	if (mc)
-	{
-		mc->numHits++;
-		mc->Action(&PowerPC::debug_interface, _Data,_Address,true,4,PC);
-	}
-#endif
+	MemCheck(_Address, _Data, true, 4);
 	WriteToHardware<u32>(_Address, _Data, FLAG_WRITE);
 }
 void Write_U32_Swap(const u32 _Data, const u32 _Address)
@@ -511,14 +506,7 @@ void Write_U32_Swap(const u32 _Data, const u32 _Address)
 
 void Write_U64(const u64 _Data, const u32 _Address)
 {
-#ifdef ENABLE_MEM_CHECK
-	TMemCheck *mc = PowerPC::memchecks.GetMemCheck(_Address);
-	if (mc)
-	{
-		mc->numHits++;
-		mc->Action(&PowerPC::debug_interface, (u32)_Data,_Address,true,8,PC);
-	}
-#endif
+	MemCheck(_Address, (u32)_Data, true, 8);
 
 	WriteToHardware<u64>(_Address, _Data, FLAG_WRITE);
 }
@@ -701,6 +689,24 @@ void SDRUpdated()
 	}
 	PowerPC::ppcState.pagetable_base = htaborg<<16;
 	PowerPC::ppcState.pagetable_hashmask = ((xx<<10)|0x3ff);
+	FlushSoftTLB();
+}
+
+void FlushSoftTLB()
+{
+	for (SoftTLBEntry& entry : soft_tlb_read)
+		entry.tag = SOFT_TLB_INVALID_TAG;
+	for (SoftTLBEntry& entry : soft_tlb_write)
+		entry.tag = SOFT_TLB_INVALID_TAG;
+}
+
+static void InvalidateSoftTLBPage(u32 vpa)
+{
+	u32 index = (vpa >> HW_PAGE_INDEX_SHIFT) & SOFT_TLB_MASK;
+	if (soft_tlb_read[index].tag == (vpa & ~0xfff))
+		soft_tlb_read[index].tag = SOFT_TLB_INVALID_TAG;
+	if (soft_tlb_write[index].tag == (vpa & ~0xfff))
+		soft_tlb_write[index].tag = SOFT_TLB_INVALID_TAG;
 }
 
 
@@ -766,7 +772,13 @@ static void UpdateTLBEntry(const XCheckTLBFlag _Flag, UPTE2 PTE2, const u32 vpa)
 		return;
 
 	PowerPC::tlb_entry *tlbe = PowerPC::ppcState.tlb[_Flag == FLAG_OPCODE][(vpa >> HW_PAGE_INDEX_SHIFT) & HW_PAGE_INDEX_MASK];
-	if ((tlbe[0].flags & TLB_FLAG_MOST_RECENT) == 0 || (tlbe[0].flags & TLB_FLAG_INVALID))
+	int way = ((tlbe[0].flags & TLB_FLAG_MOST_RECENT) == 0 || (tlbe[0].flags & TLB_FLAG_INVALID)) ? 0 : 1;
+
+	// The soft TLB may only hold pages the emulated TLB still has.
+	if (_Flag != FLAG_OPCODE && !(tlbe[way].flags & TLB_FLAG_INVALID))
+		InvalidateSoftTLBPage(tlbe[way].tag);
+
+	if (way == 0)
 	{
 		tlbe[0].flags = TLB_FLAG_MOST_RECENT;
 		tlbe[1].flags &= ~TLB_FLAG_MOST_RECENT;
@@ -792,6 +804,14 @@ void InvalidateTLBEntry(u32 vpa)
 	PowerPC::tlb_entry *tlbe_i = PowerPC::ppcState.tlb[1][(vpa >> HW_PAGE_INDEX_SHIFT) & HW_PAGE_INDEX_MASK];
 	tlbe_i[0].flags |= TLB_FLAG_INVALID;
 	tlbe_i[1].flags |= TLB_FLAG_INVALID;
+
+	// tlbie invalidates the whole congruence class, so drop every soft TLB
+	// entry that maps to the same set.
+	for (u32 i = (vpa >> HW_PAGE_INDEX_SHIFT) & HW_PAGE_INDEX_MASK; i < SOFT_TLB_SIZE; i += HW_PAGE_INDEX_MASK + 1)
+	{
+		soft_tlb_read[i].tag = SOFT_TLB_INVALID_TAG;
+		soft_tlb_write[i].tag = SOFT_TLB_INVALID_TAG;
+	}
 }
 
 // Page Address Translation
@@ -926,6 +946,35 @@ static u32 TranslateBlockAddress(const u32 addr, const XCheckTLBFlag _Flag)
 	return result;
 }
 
+// Remembers a translation done by TranslateAddress() for the MMU path of
+// ReadFromHardware()/WriteToHardware().
+static void UpdateSoftTLB(SoftTLBEntry* table, u32 em_address, u32 paddr)
+{
+	// Only cache pages that can be accessed through base + physical address.
+	u32 ppage = paddr & ~(HW_PAGE_SIZE - 1);
+	bool in_ram = ppage < RAM_SIZE;
+	bool in_exram = m_pEXRAM && (ppage & 0xF0000000) == 0x10000000 && (ppage & 0x0FFFFFFF) < EXRAM_SIZE;
+	if (!in_ram && !in_exram)
+		return;
+
+	// BAT translations aren't invalidated by tlbie, and whether a BAT applies
+	// depends on MSR[PR], so leave any address that a BAT covers in either
+	// privilege level alone.
+	if (SConfig::GetInstance().m_LocalCoreStartupParameter.bBAT)
+	{
+		u32 result;
+		if (CheckAddrBats(em_address, &result, BATU_Vs | BATU_Vp, SPR_DBAT0U))
+			return;
+		if (SConfig::GetInstance().m_LocalCoreStartupParameter.bWii && HID4.SBE &&
+		    CheckAddrBats(em_address, &result, BATU_Vs | BATU_Vp, SPR_DBAT4U))
+			return;
+	}
+
+	SoftTLBEntry& entry = table[(em_address >> HW_PAGE_INDEX_SHIFT) & SOFT_TLB_MASK];
+	entry.tag = em_address & ~(HW_PAGE_SIZE - 1);
+	entry.offset = ppage - entry.tag;
+}
+
 // Translate effective address using BAT or PAT.  Returns 0 if the address cannot be translated.
 u32 TranslateAddress(const u32 _Address, const XCheckTLBFlag _Flag)
 {
@@ -0,0 +1,231 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <algorithm>
+
+#include "Common/Atomic.h"
+#include "Core/ConfigManager.h"
+#include "Core/CoreTiming.h"
+#include "Core/Host.h"
+#include "Core/HLE/HLE.h"
+#include "Core/HW/CPU.h"
+#include "Core/PowerPC/CachedInterpreter.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "Core/PowerPC/PPCTables.h"
+
+// Same size as the JITs' code space; a block needs one record per instruction plus one.
+static const size_t CODE_SIZE = 1024 * 1024 * 32;
+
+void CachedInterpreter::Init()
+{
+	m_code.reserve(CODE_SIZE / sizeof(Instruction));
+
+	jo.enableBlocklink = false;
+
+	blocks.Init();
+
+	code_block.m_stats = &js.st;
+	code_block.m_gpa = &js.gpa;
+	code_block.m_fpa = &js.fpa;
+}
+
+void CachedInterpreter::Shutdown()
+{
+	blocks.Shutdown();
+}
+
+void CachedInterpreter::ClearCache()
+{
+	m_code.clear();
+	blocks.Clear();
+}
+
+void CachedInterpreter::SingleStep()
+{
+	Interpreter::getInstance()->SingleStep();
+}
+
+void CachedInterpreter::Run()
+{
+	while (!PowerPC::GetState())
+	{
+		if (SConfig::GetInstance().m_LocalCoreStartupParameter.bEnableDebugging)
+		{
+			while (PowerPC::ppcState.downcount > 0)
+			{
+				// Blocks are split at breakpoints, so they can only be hit at the start of one.
+				if (PowerPC::breakpoints.IsAddressBreakPoint(PC))
+				{
+					INFO_LOG(POWERPC, "Hit Breakpoint - %08x", PC);
+					CCPU::Break();
+					if (PowerPC::breakpoints.IsTempBreakPoint(PC))
+						PowerPC::breakpoints.Remove(PC);
+
+					Host_UpdateDisasmDialog();
+					return;
+				}
+				PowerPC::ppcState.downcount -= RunBlock();
+			}
+		}
+		else
+		{
+			while (PowerPC::ppcState.downcount > 0)
+				PowerPC::ppcState.downcount -= RunBlock();
+		}
+
+		CoreTiming::Advance();
+
+		if (PowerPC::ppcState.Exceptions)
+		{
+			PowerPC::CheckExceptions();
+			PC = NPC;
+		}
+	}
+}
+
+int CachedInterpreter::RunBlock()
+{
+	int block_num = blocks.GetBlockNumberFromStartAddress(PC);
+	if (block_num < 0)
+	{
+		Jit(PC);
+		block_num = blocks.GetBlockNumberFromStartAddress(PC);
+
+		// The first instruction couldn't be fetched; let the interpreter raise the exception.
+		if (block_num < 0)
+			return Interpreter::getInstance()->SingleStepInner();
+	}
+
+	Interpreter::m_EndBlock = false;
+	for (const Instruction* code = (const Instruction*)blocks.GetCodePointers()[block_num]; ; ++code)
+	{
+		switch (code->type)
+		{
+		case Instruction::TYPE_INTERPRETER:
+			PC = code->address;
+			NPC = code->address + 4;
+
+			if (code->check_fpu && !((UReg_MSR&)MSR).FP)
+			{
+				Common::AtomicOr(PowerPC::ppcState.Exceptions, EXCEPTION_FPU_UNAVAILABLE);
+				PowerPC::CheckExceptions();
+				PC = NPC;
+				return code->cycles;
+			}
+
+			code->func(code->inst);
+
+			if (PowerPC::ppcState.Exceptions & EXCEPTION_DSI)
+			{
+				PowerPC::CheckExceptions();
+				PC = NPC;
+				return code->cycles;
+			}
+
+			// Blocks end at branches already, but anything else that makes the interpreter stop
+			// (traps, for example) has to stop here too.
+			if (Interpreter::m_EndBlock)
+			{
+				PC = NPC;
+				return code->cycles;
+			}
+			break;
+
+		case Instruction::TYPE_HLE:
+			PC = code->address;
+			Interpreter::HLEFunction(code->inst);
+			// The original instruction runs next, and the rest of the block after it.
+			Interpreter::m_EndBlock = false;
+			break;
+
+		case Instruction::TYPE_HLE_REPLACE:
+			PC = code->address;
+			Interpreter::HLEFunction(code->inst);
+			PC = NPC;
+			return code->cycles;
+
+		case Instruction::TYPE_END:
+			PC = NPC;
+			return code->cycles;
+		}
+	}
+}
+
+void CachedInterpreter::Jit(u32 address)
+{
+	if (m_code.size() + code_buffer.GetSize() + 1 > m_code.capacity() || blocks.IsFull() ||
+	    SConfig::GetInstance().m_LocalCoreStartupParameter.bJITNoBlockCache)
+	{
+		ClearCache();
+	}
+
+	analyzer.Analyze(address, &code_block, &code_buffer, code_buffer.GetSize());
+	if (code_block.m_memory_exception || code_block.m_num_instructions == 0)
+		return;
+
+	PPCAnalyst::CodeOp* ops = code_buffer.codebuffer;
+	u32 num_instructions = code_block.m_num_instructions;
+
+	// The analyzer moves some instructions next to the ones that use their results for the
+	// JITs' benefit. We don't follow branches, so sorting by address restores program order.
+	std::sort(ops, ops + num_instructions, [](const PPCAnalyst::CodeOp& a, const PPCAnalyst::CodeOp& b)
+	{
+		return a.address < b.address;
+	});
+
+	// Stop the block in front of breakpoints, so that Run() sees them.
+	if (SConfig::GetInstance().m_LocalCoreStartupParameter.bEnableDebugging)
+	{
+		for (u32 i = 1; i < num_instructions; i++)
+		{
+			if (PowerPC::breakpoints.IsAddressBreakPoint(ops[i].address))
+			{
+				num_instructions = i;
+				break;
+			}
+		}
+	}
+
+	int block_num = blocks.AllocateBlock(address);
+	JitBlock* b = blocks.GetBlock(block_num);
+	size_t start = m_code.size();
+
+	u32 cycles = 0;
+	bool found_fpu = false;
+	for (u32 i = 0; i < num_instructions; i++)
+	{
+		const PPCAnalyst::CodeOp& op = ops[i];
+		cycles += op.opinfo->numCycles;
+
+		u32 function = HLE::GetFunctionIndex(op.address);
+		if (function != 0)
+		{
+			int type = HLE::GetFunctionTypeByIndex(function);
+			if ((type == HLE::HLE_HOOK_START || type == HLE::HLE_HOOK_REPLACE) &&
+			    HLE::IsEnabled(HLE::GetFunctionFlagsByIndex(function)))
+			{
+				if (type == HLE::HLE_HOOK_REPLACE)
+				{
+					m_code.push_back({nullptr, function, op.address, cycles, Instruction::TYPE_HLE_REPLACE, false});
+					num_instructions = i + 1;
+					break;
+				}
+				m_code.push_back({nullptr, function, op.address, cycles, Instruction::TYPE_HLE, false});
+			}
+		}
+
+		bool check_fpu = (op.opinfo->flags & FL_USE_FPU) && !found_fpu;
+		found_fpu |= check_fpu;
+		m_code.push_back({GetInterpreterOp(op.inst), op.inst, op.address, cycles, Instruction::TYPE_INTERPRETER, check_fpu});
+	}
+	m_code.push_back({nullptr, 0, 0, cycles, Instruction::TYPE_END, false});
+
+	b->checkedEntry = (const u8*)&m_code[start];
+	b->normalEntry = b->checkedEntry;
+	b->runCount = 0;
+	b->codeSize = (u32)((m_code.size() - start) * sizeof(Instruction));
+	b->originalSize = num_instructions;
+
+	blocks.FinalizeBlock(block_num, jo.enableBlocklink, b->checkedEntry);
+}
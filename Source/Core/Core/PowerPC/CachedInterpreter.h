@@ -0,0 +1,88 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Core/PowerPC/PPCAnalyst.h"
+#include "Core/PowerPC/Interpreter/Interpreter.h"
+#include "Core/PowerPC/JitCommon/JitBase.h"
+#include "Core/PowerPC/JitCommon/JitCache.h"
+
+// An interpreter that decodes each block once, into an array of records that hold the
+// interpreter handler of every instruction, and then just runs through that array.
+// It is a JitBase so that it shares the block cache, and with it the invalidation through
+// icbi, breakpoints and DMA, with the JITs. It doesn't generate any host code, so it
+// works on every host.
+class CachedInterpreter : public JitBase
+{
+public:
+	CachedInterpreter() : code_buffer(32000) {}
+	~CachedInterpreter() {}
+
+	void Init() override;
+	void Shutdown() override;
+
+	bool HandleFault(uintptr_t access_address, SContext* ctx) override { return false; }
+
+	void ClearCache() override;
+
+	void Run() override;
+	void SingleStep() override;
+
+	void Jit(u32 address) override;
+
+	// Runs the block at PC, compiling it first if needed, and returns the number of cycles
+	// it took. Exceptions raised by the block are left for the caller to check, as in the
+	// interpreter.
+	int RunBlock();
+
+	JitBaseBlockCache* GetBlockCache() override { return &blocks; }
+
+	const char* GetName() override
+	{
+		return "Cached Interpreter";
+	}
+
+	const CommonAsmRoutinesBase* GetAsmRoutines() override { return nullptr; }
+
+private:
+	struct Instruction
+	{
+		enum Type : u8
+		{
+			TYPE_INTERPRETER,
+			TYPE_HLE,          // HLE hook that runs before the original instruction
+			TYPE_HLE_REPLACE,  // HLE hook that replaces the function
+			TYPE_END,
+		};
+
+		Interpreter::_interpreterInstruction func;
+		UGeckoInstruction inst;
+		u32 address;
+		// Cycles of the block up to and including this instruction.
+		u32 cycles;
+		Type type;
+		// Whether this is the first FPU instruction of the block, which checks MSR.FP.
+		bool check_fpu;
+	};
+
+	// Blocks are never linked, and nothing ever jumps into the records of a destroyed block,
+	// so there is nothing to patch.
+	class BlockCache : public JitBaseBlockCache
+	{
+	private:
+		void WriteLinkBlock(u8* location, const u8* address) override {}
+		void WriteDestroyBlock(const u8* location, u32 address) override {}
+	};
+
+	BlockCache blocks;
+	PPCAnalyst::CodeBuffer code_buffer;
+
+	// The records of all blocks, back to back. It is reserved once and cleared with the block
+	// cache, so the pointers to the blocks' records stay valid.
+	std::vector<Instruction> m_code;
+};
@@ -459,6 +459,7 @@ static void gdb_read_register()
 			wbe32hex(reply, 0x0BADC0DE);
 			break;
 		case 71:
+			FlushFPRF();
 			wbe32hex(reply, FPSCR.Hex);
 			break;
 		default:
@@ -562,6 +563,7 @@ static void gdb_write_register()
 			// do nothing, we dont have MQ
 			break;
 		case 71:
+			FlushFPRF();
 			FPSCR.Hex = re32hex(bufptr);
 			break;
 		default:
@@ -49,6 +49,7 @@ inline void SetFI(int FI)
 
 inline void UpdateFPSCR()
 {
+	FlushFPRF();
 	FPSCR.VX = (FPSCR.Hex & FPSCR_VX_ANY) != 0;
 	FPSCR.FEX = 0; // we assume that "?E" bits are always 0
 }
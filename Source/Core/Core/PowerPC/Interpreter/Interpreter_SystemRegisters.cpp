@@ -51,6 +51,7 @@ void Interpreter::mtfsb0x(UGeckoInstruction _inst)
 	/*if (b & 0x9ff80700)
 		PanicAlert("mtfsb0 clears bit %d, PC=%x", _inst.CRBD, PC);*/
 
+	FlushFPRF();
 	FPSCR.Hex &= ~b;
 	FPSCRtoFPUSettings(FPSCR);
 
@@ -62,6 +63,7 @@ void Interpreter::mtfsb1x(UGeckoInstruction _inst)
 {
 	// this instruction can affect FX
 	u32 b = 0x80000000 >> _inst.CRBD;
+	FlushFPRF();
 	if (b & FPSCR_ANY_X)
 		SetFPException(b);
 	else
@@ -81,6 +83,7 @@ void Interpreter::mtfsfix(UGeckoInstruction _inst)
 	if (cleared & 0x9ff80700)
 		PanicAlert("mtfsfi clears %08x, PC=%x", cleared, PC);*/
 
+	FlushFPRF();
 	FPSCR.Hex = (FPSCR.Hex & ~mask) | (imm >> (4 * _inst.CRFD));
 
 	FPSCRtoFPUSettings(FPSCR);
@@ -103,6 +106,7 @@ void Interpreter::mtfsfx(UGeckoInstruction _inst)
 	if (cleared & 0x9ff80700)
 		PanicAlert("mtfsf clears %08x, PC=%x", cleared, PC);*/
 
+	FlushFPRF();
 	FPSCR.Hex = (FPSCR.Hex & ~m) | ((u32)(riPS0(_inst.FB)) & m);
 	FPSCRtoFPUSettings(FPSCR);
 
@@ -175,6 +179,7 @@ static void SetSR(int index, u32 value)
 {
 	DEBUG_LOG(POWERPC, "%08x: MMU: Segment register %i set to %08x", PowerPC::ppcState.pc, index, value);
 	PowerPC::ppcState.sr[index] = value;
+	Memory::FlushSoftTLB();
 }
 
 void Interpreter::mtsr(UGeckoInstruction _inst)
@@ -354,6 +359,28 @@ void Interpreter::mtspr(UGeckoInstruction _inst)
 		Memory::SDRUpdated();
 		break;
 
+	// Data BATs take precedence over the page table
+	case SPR_DBAT0U:
+	case SPR_DBAT0L:
+	case SPR_DBAT1U:
+	case SPR_DBAT1L:
+	case SPR_DBAT2U:
+	case SPR_DBAT2L:
+	case SPR_DBAT3U:
+	case SPR_DBAT3L:
+	case SPR_DBAT4U:
+	case SPR_DBAT4L:
+	case SPR_DBAT5U:
+	case SPR_DBAT5L:
+	case SPR_DBAT6U:
+	case SPR_DBAT6L:
+	case SPR_DBAT7U:
+	case SPR_DBAT7L:
+	case SPR_HID4:
+		if (oldValue != rSPR(iIndex))
+			Memory::FlushSoftTLB();
+		break;
+
 	case SPR_XER:
 		SetXER(rSPR(iIndex));
 		break;
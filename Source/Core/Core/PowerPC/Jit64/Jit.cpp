@@ -2,6 +2,9 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <cinttypes>
+#include <iterator>
 #include <map>
 #include <string>
 
@@ -11,7 +14,11 @@
 #endif
 
 #include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Common/JitRegister.h"
 #include "Common/StringUtil.h"
+#include "Common/Timer.h"
+#include "Core/Movie.h"
 #include "Core/PatchEngine.h"
 #include "Core/HLE/HLE.h"
 #include "Core/HW/ProcessorInterface.h"
@@ -194,6 +201,7 @@ void Jit64::Init()
 	if (m_enable_blr_optimization)
 		AllocStack();
 
+	dispatcher_stats = {};
 	blocks.Init();
 	asm_routines.Init(m_stack ? (m_stack + STACK_SIZE) : nullptr);
 
@@ -201,10 +209,59 @@ void Jit64::Init()
 	// it'll crash because the farcode functions get cleared on JIT clears.
 	farcode.Init(js.memcheck ? FARCODE_SIZE_MMU : FARCODE_SIZE);
 
+	// Both regions are still empty, so this is where the code segments start.
+	m_near_code_start = GetWritableCodePtr();
+	m_far_code_start = farcode.GetWritableCodePtr();
+	m_near_segment_size = CODE_SIZE / NUM_CODE_SEGMENTS;
+	m_far_segment_size = (js.memcheck ? FARCODE_SIZE_MMU : FARCODE_SIZE) / NUM_CODE_SEGMENTS;
+
 	code_block.m_stats = &js.st;
 	code_block.m_gpa = &js.gpa;
 	code_block.m_fpa = &js.fpa;
 	EnableOptimization();
+
+	// The disk cache only tells us what to translate early, which is pointless
+	// when the block cache is bypassed and confusing when stepping through code.
+	const SCoreStartupParameter& startup = SConfig::GetInstance().m_LocalCoreStartupParameter;
+	if (startup.bJITDiskCache && !startup.bJITNoBlockCache && !startup.bEnableDebugging && !startup.bMMU)
+		m_disk_cache.Init(startup.GetUniqueID());
+	m_precompile_asap = true;
+
+	// Hot blocks follow branches, which needs block linking to be worth it and
+	// the analyzer to be free to read ahead.
+	m_enable_tiering = startup.bJITTieredCompilation && jo.enableBlocklink && !startup.bJITNoBlockCache &&
+	                   !startup.bJITOff && !startup.bJITBranchOff && !startup.bEnableDebugging && !startup.bMMU;
+	m_hot_blocks.clear();
+	m_num_hot_recompiles = 0;
+
+	// Interpreting first and compiling later only makes sense with a block
+	// cache, and would get in the way of stepping through code.
+	m_enable_deferred_compile = startup.bJITDeferredCompilation && !startup.bJITNoBlockCache &&
+	                            !startup.bEnableDebugging && !startup.bMMU;
+	m_compile_queue.clear();
+	m_queued_blocks.clear();
+	m_num_interpreted_blocks = 0;
+	m_num_deferred_compiles = 0;
+
+	// Without a block cache everything is thrown away after every block anyway.
+	m_enable_partial_eviction = startup.bJITPartialEviction && !startup.bJITNoBlockCache;
+	ResetCodeSegments();
+	m_num_full_flushes = 0;
+	m_num_segment_evictions = 0;
+	m_num_evicted_blocks = 0;
+
+	if (startup.bProfileCallStacks)
+	{
+		Profiler::g_ProfileCallStacks = true;
+		Profiler::ResetCallStacks();
+	}
+
+	m_session_start_ms = Common::Timer::GetTimeMs();
+	m_session_start_frame = Movie::g_currentFrame;
+	m_compile_time_first_frame_us = 0;
+	m_compile_time_first_minute_us = 0;
+	m_compile_time_total_us = 0;
+	m_num_precompiled_blocks = 0;
 }
 
 void Jit64::ClearCache()
@@ -214,10 +271,127 @@ void Jit64::ClearCache()
 	farcode.ClearCodeSpace();
 	ClearCodeSpace();
 	m_clear_cache_asap = false;
+	m_hot_blocks.clear();
+	m_compile_queue.clear();
+	m_queued_blocks.clear();
+	ResetCodeSegments();
+}
+
+void Jit64::ResetCodeSegments()
+{
+	m_current_segment = 0;
+	m_eviction_hand = 1;
+	m_segment_used.fill(0);
+	for (std::vector<int>& segment_blocks : m_segment_blocks)
+		segment_blocks.clear();
+}
+
+bool Jit64::HasCodeSpace(size_t margin)
+{
+	// Trampolines are shared between blocks, so they are only ever cleared
+	// with everything else.
+	if (blocks.IsFull() || trampolines.GetSpaceLeft() < margin)
+		return false;
+
+	if (!m_enable_partial_eviction)
+		return GetSpaceLeft() >= margin && farcode.GetSpaceLeft() >= margin;
+
+	const u8* near_end = m_near_code_start + (m_current_segment + 1) * m_near_segment_size;
+	const u8* far_end = m_far_code_start + (m_current_segment + 1) * m_far_segment_size;
+	return (size_t)(near_end - GetCodePtr()) >= margin && (size_t)(far_end - farcode.GetCodePtr()) >= margin;
+}
+
+void Jit64::MakeCodeSpace()
+{
+	if (m_enable_partial_eviction && trampolines.GetSpaceLeft() >= 0x10000)
+	{
+		// The segment that was being filled holds the newest blocks, so it gets
+		// a second chance. Two sweeps always find a segment, even if every one
+		// of them has run since the last eviction.
+		m_segment_used[m_current_segment] = 1;
+		for (u32 i = 0; i < 2 * NUM_CODE_SEGMENTS; i++)
+		{
+			u32 segment = m_eviction_hand;
+			m_eviction_hand = (m_eviction_hand + 1) % NUM_CODE_SEGMENTS;
+			if (m_segment_used[segment])
+			{
+				m_segment_used[segment] = 0;
+				continue;
+			}
+
+			EvictCodeSegment(segment);
+			if (HasCodeSpace(0x10000))
+				return;
+		}
+	}
+
+	ClearCache();
+	m_num_full_flushes++;
+}
+
+void Jit64::EvictCodeSegment(u32 segment)
+{
+	u8* near_start = m_near_code_start + segment * m_near_segment_size;
+	u8* near_end = near_start + m_near_segment_size;
+	u8* far_start = m_far_code_start + segment * m_far_segment_size;
+	u8* far_end = far_start + m_far_segment_size;
+
+	for (int block_num : m_segment_blocks[segment])
+	{
+		// JitInterface::ClearSafe() clears the block cache but leaves the code,
+		// so block numbers in the list may have been handed out again since.
+		JitBlock* b = blocks.GetBlock(block_num);
+		if (block_num < blocks.GetNumBlocks() && b->normalEntry >= near_start && b->normalEntry < near_end)
+		{
+			blocks.FreeBlock(block_num);
+			m_num_evicted_blocks++;
+		}
+	}
+	m_segment_blocks[segment].clear();
+
+	// Backpatch info for the old code would be picked up by new code that
+	// happens to fault at the same place.
+	auto in_segment = [&](u8* p)
+	{
+		return (p >= near_start && p < near_end) || (p >= far_start && p < far_end);
+	};
+	for (auto it = registersInUseAtLoc.begin(); it != registersInUseAtLoc.end();)
+		it = in_segment(it->first) ? registersInUseAtLoc.erase(it) : std::next(it);
+	for (auto it = pcAtLoc.begin(); it != pcAtLoc.end();)
+		it = in_segment(it->first) ? pcAtLoc.erase(it) : std::next(it);
+
+	SetCodePtr(near_start);
+	farcode.SetCodePtr(far_start);
+	m_current_segment = segment;
+	m_num_segment_evictions++;
 }
 
 void Jit64::Shutdown()
 {
+	NOTICE_LOG(DYNA_REC, "JIT64 compile time: first frame %" PRIu64 " ms, first minute %" PRIu64 " ms, total %" PRIu64 " ms (%u blocks precompiled from disk cache)",
+	           m_compile_time_first_frame_us / 1000, m_compile_time_first_minute_us / 1000,
+	           m_compile_time_total_us / 1000, m_num_precompiled_blocks);
+	if (m_enable_tiering)
+		NOTICE_LOG(DYNA_REC, "JIT64 tiered compilation: %u hot blocks recompiled", m_num_hot_recompiles);
+	if (m_enable_deferred_compile)
+		NOTICE_LOG(DYNA_REC, "JIT64 deferred compilation: %u blocks interpreted first, %u compiled from the queue",
+		           m_num_interpreted_blocks, m_num_deferred_compiles);
+	NOTICE_LOG(DYNA_REC, "JIT64 code cache: %u full flushes, %u segment evictions (%u blocks evicted)",
+	           m_num_full_flushes, m_num_segment_evictions, m_num_evicted_blocks);
+	NOTICE_LOG(DYNA_REC, "JIT64 dispatcher: %" PRIu64 " lookups, %" PRIu64 " misses; blr: %" PRIu64 " predicted, %" PRIu64 " mispredicted",
+	           dispatcher_stats.lookups, dispatcher_stats.misses, dispatcher_stats.blr_hits, dispatcher_stats.blr_mispredicts);
+	m_disk_cache.Shutdown();
+
+	if (Profiler::g_ProfileCallStacks)
+	{
+		std::string filename = File::GetUserPath(D_DUMP_IDX) + "Debug/callstacks-" +
+		                       SConfig::GetInstance().m_LocalCoreStartupParameter.GetUniqueID() + ".txt";
+		File::CreateFullPath(filename);
+		Profiler::WriteCallStacks(filename);
+		Profiler::g_ProfileCallStacks = false;
+		NOTICE_LOG(DYNA_REC, "JIT64 guest call stacks written to %s", filename.c_str());
+	}
+
 	FreeStack();
 	FreeCodeSpace();
 
@@ -317,6 +491,13 @@ bool Jit64::Cleanup()
 
 void Jit64::WriteExit(u32 destination, bool bl, u32 after)
 {
+	if (bl && Profiler::g_ProfileCallStacks)
+	{
+		ABI_PushRegistersAndAdjustStack({}, 0);
+		ABI_CallFunctionCC((void *)&Profiler::OnGuestCall, destination, after);
+		ABI_PopRegistersAndAdjustStack({}, 0);
+	}
+
 	if (!m_enable_blr_optimization)
 		bl = false;
 
@@ -341,6 +522,10 @@ void Jit64::JustWriteExit(u32 destination, bool bl, u32 after)
 	linkData.exitAddress = destination;
 	linkData.linkStatus = false;
 
+	// Set pc even if the exit is linked, so the block cache can unlink it again.
+	MOV(32, PPCSTATE(pc), Imm32(destination));
+	linkData.exitPtrs = GetWritableCodePtr();
+
 	// Link opportunity!
 	int block;
 	if (jo.enableBlocklink && (block = blocks.GetBlockNumberFromStartAddress(destination)) >= 0)
@@ -348,7 +533,6 @@ void Jit64::JustWriteExit(u32 destination, bool bl, u32 after)
 		// It exists! Joy of joy!
 		JitBlock* jb = blocks.GetBlock(block);
 		const u8* addr = jb->checkedEntry;
-		linkData.exitPtrs = GetWritableCodePtr();
 		if (bl)
 			CALL(addr);
 		else
@@ -357,8 +541,6 @@ void Jit64::JustWriteExit(u32 destination, bool bl, u32 after)
 	}
 	else
 	{
-		MOV(32, PPCSTATE(pc), Imm32(destination));
-		linkData.exitPtrs = GetWritableCodePtr();
 		if (bl)
 			CALL(asm_routines.dispatcher);
 		else
@@ -376,9 +558,17 @@ void Jit64::JustWriteExit(u32 destination, bool bl, u32 after)
 
 void Jit64::WriteExitDestInRSCRATCH(bool bl, u32 after)
 {
+	MOV(32, PPCSTATE(pc), R(RSCRATCH));
+	if (bl && Profiler::g_ProfileCallStacks)
+	{
+		ABI_PushRegistersAndAdjustStack({}, 0);
+		ABI_CallFunctionAC(32, (void *)&Profiler::OnGuestCall, R(RSCRATCH), after);
+		ABI_PopRegistersAndAdjustStack({}, 0);
+		MOV(32, R(RSCRATCH), PPCSTATE(pc));
+	}
+
 	if (!m_enable_blr_optimization)
 		bl = false;
-	MOV(32, PPCSTATE(pc), R(RSCRATCH));
 	Cleanup();
 
 	if (bl)
@@ -402,6 +592,13 @@ void Jit64::WriteExitDestInRSCRATCH(bool bl, u32 after)
 
 void Jit64::WriteBLRExit()
 {
+	if (Profiler::g_ProfileCallStacks)
+	{
+		ABI_PushRegistersAndAdjustStack({RSCRATCH}, 0);
+		ABI_CallFunctionR((void *)&Profiler::OnGuestReturn, RSCRATCH);
+		ABI_PopRegistersAndAdjustStack({RSCRATCH}, 0);
+	}
+
 	if (!m_enable_blr_optimization)
 	{
 		WriteExitDestInRSCRATCH();
@@ -414,6 +611,8 @@ void Jit64::WriteBLRExit()
 	MOV(32, R(RSCRATCH2), Imm32(js.downcountAmount));
 	CMP(64, R(RSCRATCH), MDisp(RSP, 8));
 	J_CC(CC_NE, asm_routines.dispatcherMispredictedBLR);
+	MOV(64, R(RSCRATCH), ImmPtr(&dispatcher_stats.blr_hits));
+	ADD(64, MatR(RSCRATCH), Imm8(1));
 	SUB(32, PPCSTATE(downcount), R(RSCRATCH2));
 	RET();
 }
@@ -442,6 +641,15 @@ void Jit64::WriteExceptionExit()
 	JMP(asm_routines.dispatcher, true);
 }
 
+void Jit64::WriteIdleExit(u32 destination)
+{
+	ABI_PushRegistersAndAdjustStack({}, 0);
+	ABI_CallFunctionC((void *)&PowerPC::OnIdleLoop, destination);
+	ABI_PopRegistersAndAdjustStack({}, 0);
+	MOV(32, PPCSTATE(pc), Imm32(destination));
+	WriteExceptionExit();
+}
+
 void Jit64::WriteExternalExceptionExit()
 {
 	Cleanup();
@@ -491,21 +699,158 @@ void Jit64::Trace()
 
 void Jit64::Jit(u32 em_address)
 {
-	if (GetSpaceLeft() < 0x10000 ||
-	    farcode.GetSpaceLeft() < 0x10000 ||
-		blocks.IsFull() ||
-		SConfig::GetInstance().m_LocalCoreStartupParameter.bJITNoBlockCache ||
+	if (SConfig::GetInstance().m_LocalCoreStartupParameter.bJITNoBlockCache ||
 		m_clear_cache_asap)
 	{
 		ClearCache();
 	}
+	else if (!HasCodeSpace(0x10000))
+	{
+		MakeCodeSpace();
+	}
 
+	u64 start_us = Common::Timer::GetTimeUs();
+
+	// Translate everything the disk cache knows about as soon as there is code
+	// to translate, and again whenever execution reaches a recorded block that
+	// wasn't in memory yet the last time we looked (e.g. a newly loaded REL).
+	if (m_disk_cache.IsEnabled() && !Core::g_want_determinism &&
+	    (m_precompile_asap || m_disk_cache.IsPendingAndValid(em_address)))
+	{
+		m_precompile_asap = false;
+		PrecompileCachedBlocks();
+	}
+
+	if (blocks.GetBlockNumberFromStartAddress(em_address) < 0)
+	{
+		// Movies and netplay need the same code to run the same way every time,
+		// and the interpreter doesn't round or count cycles quite like the JIT.
+		if (m_enable_deferred_compile && !Core::g_want_determinism &&
+		    !m_hot_blocks.count(em_address) && !m_queued_blocks.count(em_address))
+		{
+			CompileQueuedBlocks(start_us);
+			m_compile_queue.push_back(em_address);
+			m_queued_blocks.insert(em_address);
+			UpdateCompileTime(start_us);
+
+			InterpretBlock();
+			m_num_interpreted_blocks++;
+			return;
+		}
+
+		m_queued_blocks.erase(em_address);
+		CompileBlock(em_address);
+	}
+
+	UpdateCompileTime(start_us);
+}
+
+void Jit64::CompileBlock(u32 em_address)
+{
+	bool hot = m_hot_blocks.count(em_address) != 0;
 	int block_num = blocks.AllocateBlock(em_address);
+	m_segment_blocks[m_current_segment].push_back(block_num);
 	JitBlock *b = blocks.GetBlock(block_num);
-	blocks.FinalizeBlock(block_num, jo.enableBlocklink, DoJit(em_address, &code_buffer, b));
+	blocks.FinalizeBlock(block_num, jo.enableBlocklink, DoJit(em_address, &code_buffer, b, hot));
+	if (hot)
+		m_num_hot_recompiles++;
+	else
+		m_disk_cache.AddBlock(em_address, b->originalSize);
 }
 
-const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buf, JitBlock *b)
+void Jit64::CompileQueuedBlocks(u64 start_us)
+{
+	while (!m_compile_queue.empty() && Common::Timer::GetTimeUs() - start_us < DEFERRED_COMPILE_BUDGET_US)
+	{
+		// Leave enough room for the block that was actually requested.
+		if (!HasCodeSpace(0x20000))
+			break;
+
+		u32 address = m_compile_queue.front();
+		m_compile_queue.pop_front();
+
+		// Blocks that were needed again before their turn are already compiled.
+		if (!m_queued_blocks.erase(address) || blocks.GetBlockNumberFromStartAddress(address) >= 0)
+			continue;
+
+		CompileBlock(address);
+		m_num_deferred_compiles++;
+	}
+}
+
+void Jit64::InterpretBlock()
+{
+	// The dispatcher checks downcount again after Jit() returns, and handles
+	// external exceptions from there like after any other block.
+	Interpreter* interpreter = Interpreter::getInstance();
+	Interpreter::m_EndBlock = false;
+	int cycles = 0;
+	while (!Interpreter::m_EndBlock)
+		cycles += interpreter->SingleStepInner();
+	PowerPC::ppcState.downcount -= cycles;
+}
+
+void Jit64::PrecompileCachedBlocks()
+{
+	for (const JitDiskCache::BlockKey& key : m_disk_cache.TakeValidBlocks())
+	{
+		// Leave enough room for the block that was actually requested.
+		if (!HasCodeSpace(0x20000))
+			break;
+
+		if (blocks.GetBlockNumberFromStartAddress(key.address) >= 0)
+			continue;
+
+		int block_num = blocks.AllocateBlock(key.address);
+		m_segment_blocks[m_current_segment].push_back(block_num);
+		JitBlock *b = blocks.GetBlock(block_num);
+		blocks.FinalizeBlock(block_num, jo.enableBlocklink, DoJit(key.address, &code_buffer, b));
+		m_num_precompiled_blocks++;
+	}
+}
+
+void Jit64::UpdateCompileTime(u64 start_us)
+{
+	u64 elapsed_us = Common::Timer::GetTimeUs() - start_us;
+
+	m_compile_time_total_us += elapsed_us;
+	if (Movie::g_currentFrame == m_session_start_frame)
+		m_compile_time_first_frame_us += elapsed_us;
+	if (Common::Timer::GetTimeMs() - m_session_start_ms < 60 * 1000)
+		m_compile_time_first_minute_us += elapsed_us;
+}
+
+void Jit64::TierUp(u32 address)
+{
+	Jit64* jit64 = static_cast<Jit64*>(jit);
+	int block_num = jit64->blocks.GetBlockNumberFromStartAddress(address);
+	if (block_num < 0)
+		return;
+
+	// The block stays reachable through the links into it; they get pointed at
+	// the hot version as soon as the dispatcher has compiled it.
+	jit64->m_hot_blocks.insert(address);
+	jit64->blocks.DestroyBlockForRecompile(block_num);
+}
+
+void Jit64::SetPhysicalRanges(JitBlock* b, const PPCAnalyst::CodeOp* ops, u32 num_instructions)
+{
+	std::vector<u32> addresses;
+	for (u32 i = 0; i < num_instructions; i++)
+		addresses.push_back(ops[i].address & 0x1FFFFFFF);
+	std::sort(addresses.begin(), addresses.end());
+
+	b->physicalRanges.clear();
+	for (u32 address : addresses)
+	{
+		if (!b->physicalRanges.empty() && address <= b->physicalRanges.back().second + 1)
+			b->physicalRanges.back().second = std::max(b->physicalRanges.back().second, address + 3);
+		else
+			b->physicalRanges.emplace_back(address, address + 3);
+	}
+}
+
+const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buf, JitBlock *b, bool hot)
 {
 	int blockSize = code_buf->GetSize();
 
@@ -532,6 +877,8 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buf, JitBloc
 		}
 	}
 
+	const u8* far_start = farcode.GetCodePtr();
+
 	js.firstFPInstructionFound = false;
 	js.isLastInstruction = false;
 	js.blockStart = em_address;
@@ -542,7 +889,13 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buf, JitBloc
 
 	// Analyze the block, collect all instructions it is made of (including inlining,
 	// if that is enabled), reorder instructions for optimal performance, and join joinable instructions.
+	// Hot blocks are allowed to continue into the targets of unconditional
+	// branches and calls, which gives longer blocks with fewer exits.
+	if (hot)
+		analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_LEAF_INLINE);
 	u32 nextPC = analyzer.Analyze(em_address, &code_block, code_buf, blockSize);
+	if (hot)
+		analyzer.ClearOption(PPCAnalyst::PPCAnalyzer::OPTION_LEAF_INLINE);
 
 	PPCAnalyst::CodeOp *ops = code_buf->codebuffer;
 
@@ -559,6 +912,12 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buf, JitBloc
 	const u8 *normalEntry = GetCodePtr();
 	b->normalEntry = normalEntry;
 
+	if (m_enable_partial_eviction)
+	{
+		MOV(64, R(RSCRATCH), ImmPtr(&m_segment_used[m_current_segment]));
+		MOV(8, MatR(RSCRATCH), Imm8(1));
+	}
+
 	if (ImHereDebug)
 	{
 		ABI_PushRegistersAndAdjustStack({}, 0);
@@ -577,6 +936,26 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buf, JitBloc
 		// get start tic
 		PROFILER_QUERY_PERFORMANCE_COUNTER(&b->ticStart);
 	}
+	// Count down the executions of a cold block and have it recompiled once it
+	// gets hot. The exit goes straight back to the dispatcher, which finds the
+	// block gone and compiles the hot version before anything else runs.
+	if (m_enable_tiering && !hot)
+	{
+		b->tierUpCounter = TIER_UP_THRESHOLD;
+		MOV(64, R(RSCRATCH), ImmPtr(&b->tierUpCounter));
+		SUB(32, MatR(RSCRATCH), Imm8(1));
+		FixupBranch tier_up = J_CC(CC_Z, true);
+
+		SwitchToFarCode();
+		SetJumpTarget(tier_up);
+		MOV(32, PPCSTATE(pc), Imm32(js.blockStart));
+		ABI_PushRegistersAndAdjustStack({}, 0);
+		ABI_CallFunctionC((void *)&TierUp, js.blockStart);
+		ABI_PopRegistersAndAdjustStack({}, 0);
+		JMP(asm_routines.dispatcherNoCheck, true);
+		SwitchToNearCode();
+	}
+
 #if defined(_DEBUG) || defined(DEBUGFAST) || defined(NAN_CHECK)
 	// should help logged stack-traces become more accurate
 	MOV(32, PPCSTATE(pc), Imm32(js.blockStart));
@@ -777,6 +1156,14 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buf, JitBloc
 				SwitchToNearCode();
 			}
 
+			// If a register is going to be overwritten before anything can look at it, throw it
+			// away without storing it. Breakpoints can stop on any instruction, though.
+			if (!SConfig::GetInstance().m_LocalCoreStartupParameter.bEnableDebugging)
+			{
+				for (int j : ops[i].gprDiscardable)
+					gpr.DiscardRegContentsIfCached(j);
+			}
+
 			if (opinfo->flags & FL_LOADSTORE)
 				++jit->js.numLoadStoreInst;
 
@@ -835,6 +1222,13 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buf, JitBloc
 
 	b->codeSize = (u32)(GetCodePtr() - normalEntry);
 	b->originalSize = code_block.m_num_instructions;
+	b->spillCount = gpr.NumSpills() + fpr.NumSpills();
+	b->reloadCount = gpr.NumReloads() + fpr.NumReloads();
+	if (hot)
+		SetPhysicalRanges(b, ops, code_block.m_num_instructions);
+
+	// The near code is registered along with the block by the block cache.
+	JitRegister::Register(far_start, (u32)(farcode.GetCodePtr() - far_start), "JIT_PPC_%08x_far", em_address);
 
 #ifdef JIT_LOG_X86
 	LogGeneratedX86(code_block.m_num_instructions, code_buf, normalEntry, b);
@@ -18,6 +18,10 @@
 // ----------
 #pragma once
 
+#include <array>
+#include <deque>
+#include <unordered_set>
+
 #include "Common/x64ABI.h"
 #include "Common/x64Analyzer.h"
 #include "Common/x64Emitter.h"
@@ -35,6 +39,7 @@
 #include "Core/PowerPC/JitCommon/Jit_Util.h"
 #include "Core/PowerPC/JitCommon/JitBase.h"
 #include "Core/PowerPC/JitCommon/JitCache.h"
+#include "Core/PowerPC/JitCommon/JitDiskCache.h"
 
 class Jit64 : public Jitx86Base
 {
@@ -54,6 +59,83 @@ private:
 	bool m_clear_cache_asap;
 	u8* m_stack;
 
+	JitDiskCache m_disk_cache;
+	bool m_precompile_asap;
+
+	// Time spent in Jit(), split by how far into the session it happened, so
+	// the effect of the disk cache on startup stutter can be measured.
+	u32 m_session_start_ms;
+	u64 m_session_start_frame;
+	u64 m_compile_time_first_frame_us;
+	u64 m_compile_time_first_minute_us;
+	u64 m_compile_time_total_us;
+	u32 m_num_precompiled_blocks;
+
+	void PrecompileCachedBlocks();
+	void UpdateCompileTime(u64 start_us);
+
+	// Tiered compilation: blocks are first compiled cheaply with an execution
+	// counter, and compiled again with more aggressive analysis once they have
+	// run TIER_UP_THRESHOLD times.
+	enum
+	{
+		TIER_UP_THRESHOLD = 2000,
+	};
+	bool m_enable_tiering;
+	std::unordered_set<u32> m_hot_blocks;
+	u32 m_num_hot_recompiles;
+
+	static void TierUp(u32 address);
+	void SetPhysicalRanges(JitBlock* b, const PPCAnalyst::CodeOp* ops, u32 num_instructions);
+
+	// Deferred compilation: the first time execution reaches an address, the
+	// block is run in the interpreter and queued. Queued blocks are compiled a
+	// few at a time on later misses, or right away if execution comes back to
+	// them, so entering a new area of code doesn't stall on compiling all of it.
+	enum
+	{
+		DEFERRED_COMPILE_BUDGET_US = 500,
+	};
+	bool m_enable_deferred_compile;
+	std::deque<u32> m_compile_queue;
+	std::unordered_set<u32> m_queued_blocks;
+	u32 m_num_interpreted_blocks;
+	u32 m_num_deferred_compiles;
+
+	void CompileBlock(u32 em_address);
+	void CompileQueuedBlocks(u64 start_us);
+	void InterpretBlock();
+
+	// Partial eviction: the near and far code spaces are split into segments,
+	// and blocks are compiled into the current one. Once it is full, or no
+	// block numbers are left, the blocks of a segment that hasn't run lately
+	// are thrown out and its space reused, instead of clearing the whole cache.
+	// Every block marks its segment as used when it runs; the segments are
+	// swept like a clock, clearing the marks, until one without is found.
+	enum
+	{
+		NUM_CODE_SEGMENTS = 8,
+	};
+	bool m_enable_partial_eviction;
+	u8* m_near_code_start;
+	u8* m_far_code_start;
+	size_t m_near_segment_size;
+	size_t m_far_segment_size;
+	u32 m_current_segment;
+	u32 m_eviction_hand;
+	std::array<u8, NUM_CODE_SEGMENTS> m_segment_used;
+	std::array<std::vector<int>, NUM_CODE_SEGMENTS> m_segment_blocks;
+
+	// How often the code cache ran out of room, and what was done about it.
+	u32 m_num_full_flushes;
+	u32 m_num_segment_evictions;
+	u32 m_num_evicted_blocks;
+
+	bool HasCodeSpace(size_t margin);
+	void MakeCodeSpace();
+	void EvictCodeSegment(u32 segment);
+	void ResetCodeSegments();
+
 public:
 	Jit64() : code_buffer(32000) {}
 	~Jit64() {}
@@ -71,7 +153,7 @@ public:
 	// Jit!
 
 	void Jit(u32 em_address) override;
-	const u8* DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buffer, JitBlock *b);
+	const u8* DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buffer, JitBlock *b, bool hot = false);
 
 	BitSet32 CallerSavedRegistersInUse();
 
@@ -107,6 +189,9 @@ public:
 	void WriteExitDestInRSCRATCH(bool bl = false, u32 after = 0);
 	void WriteBLRExit();
 	void WriteExceptionExit();
+	// Skips ahead to the next event and then exits to destination, for the branch
+	// back to the start of a busy-wait loop.
+	void WriteIdleExit(u32 destination);
 	void WriteExternalExceptionExit();
 	void WriteRfiExitDestInRSCRATCH();
 	void WriteCallInterpreter(UGeckoInstruction _inst);
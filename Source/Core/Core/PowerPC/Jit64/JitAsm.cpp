@@ -2,6 +2,7 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include "Common/JitRegister.h"
 #include "Common/MemoryUtil.h"
 
 #include "Core/PowerPC/Jit64/Jit.h"
@@ -57,7 +58,20 @@ void Jit64AsmRoutineManager::Generate()
 		ABI_PopRegistersAndAdjustStack(1 << RSCRATCH2, 0);
 		#endif
 
-		ResetStack();
+		MOV(64, R(RSCRATCH), ImmPtr(&jit->dispatcher_stats.blr_mispredicts));
+		ADD(64, MatR(RSCRATCH), Imm8(1));
+
+		// Only drop the prediction that was wrong. The ones below it are still
+		// good if the code just returned somewhere unexpected once, e.g. after
+		// changing LR by hand. The bottom of the stack can't pass the test.
+		if (m_stack_top)
+			MOV(64, R(RSCRATCH), Imm64((u64)m_stack_top - 0x20));
+		else
+			MOV(64, R(RSCRATCH), M(&s_saved_rsp));
+		CMP(64, R(RSP), R(RSCRATCH));
+		FixupBranch at_bottom = J_CC(CC_AE);
+		ADD(64, R(RSP), Imm8(16));
+		SetJumpTarget(at_bottom);
 
 		SUB(32, PPCSTATE(downcount), R(RSCRATCH2));
 
@@ -83,6 +97,8 @@ void Jit64AsmRoutineManager::Generate()
 			SetJumpTarget(skipToRealDispatch);
 
 			dispatcherNoCheck = GetCodePtr();
+			MOV(64, R(RSCRATCH), ImmPtr(&jit->dispatcher_stats.lookups));
+			ADD(64, MatR(RSCRATCH), Imm8(1));
 			MOV(32, R(RSCRATCH), PPCSTATE(pc));
 
 			u32 mask = 0;
@@ -136,9 +152,14 @@ void Jit64AsmRoutineManager::Generate()
 			// Jit might have cleared the code cache
 			ResetStack();
 
+			// It might also have run the block in the interpreter, using up the slice.
+			CMP(32, PPCSTATE(downcount), Imm8(0));
+			FixupBranch interpretedToEnd = J_CC(CC_LE, true);
+
 			JMP(dispatcherNoCheck); // no point in special casing this
 
 		SetJumpTarget(bail);
+		SetJumpTarget(interpretedToEnd);
 		doTiming = GetCodePtr();
 
 		// Test external exceptions.
@@ -166,6 +187,8 @@ void Jit64AsmRoutineManager::Generate()
 	ABI_PopRegistersAndAdjustStack(ABI_ALL_CALLEE_SAVED, 8, 16);
 	RET();
 
+	JitRegister::Register(enterCode, GetCodePtr(), "JIT_Loop");
+
 	GenerateCommon();
 }
 
@@ -192,11 +215,17 @@ void Jit64AsmRoutineManager::GenerateCommon()
 	GenFrsqrte();
 	fres = AlignCode4();
 	GenFres();
+	const u8* quantized = GetCodePtr();
 
 	GenQuantizedLoads();
 	GenQuantizedStores();
 	GenQuantizedSingleStores();
 
+	JitRegister::Register(fifoDirectWrite8, frsqrte, "JIT_FifoWrite");
+	JitRegister::Register(frsqrte, fres, "JIT_Frsqrte");
+	JitRegister::Register(fres, quantized, "JIT_Fres");
+	JitRegister::Register(quantized, GetCodePtr(), "JIT_QuantizedLoadStore");
+
 	//CMPSD(R(XMM0), M(&zero),
 	// TODO
 
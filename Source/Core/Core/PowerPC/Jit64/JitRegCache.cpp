@@ -11,12 +11,16 @@
 using namespace Gen;
 using namespace PowerPC;
 
-RegCache::RegCache() : emit(nullptr)
+RegCache::RegCache() : emit(nullptr), num_spills(0), num_reloads(0)
 {
 }
 
 void RegCache::Start()
 {
+	num_spills = 0;
+	num_reloads = 0;
+	spilled = BitSet32(0);
+
 	for (auto& xreg : xregs)
 	{
 		xreg.free = true;
@@ -102,7 +106,7 @@ BitSet32 GPRRegCache::GetRegUtilization()
 
 BitSet32 FPURegCache::GetRegUtilization()
 {
-	return jit->js.op->gprInReg;
+	return jit->js.op->fprInXmm;
 }
 
 BitSet32 GPRRegCache::CountRegsIn(size_t preg, u32 lookahead)
@@ -198,6 +202,9 @@ X64Reg RegCache::GetFreeXReg()
 
 	if (best_xreg != INVALID_REG)
 	{
+		if (xregs[best_xreg].dirty)
+			num_spills++;
+		spilled[best_preg] = true;
 		StoreFromRegister(best_preg);
 		return best_xreg;
 	}
@@ -242,15 +249,18 @@ int RegCache::SanityCheck() const
 
 void RegCache::DiscardRegContentsIfCached(size_t preg)
 {
+	if (!regs[preg].away)
+		return;
+
 	if (IsBound(preg))
 	{
 		X64Reg xr = regs[preg].location.GetSimpleReg();
 		xregs[xr].free = true;
 		xregs[xr].dirty = false;
 		xregs[xr].ppcReg = INVALID_REG;
-		regs[preg].away = false;
-		regs[preg].location = GetDefaultLocation(preg);
 	}
+	regs[preg].away = false;
+	regs[preg].location = GetDefaultLocation(preg);
 }
 
 
@@ -321,7 +331,12 @@ void RegCache::BindToRegister(size_t i, bool doLoad, bool makeDirty)
 		xregs[xr].ppcReg = i;
 		xregs[xr].dirty = makeDirty || regs[i].location.IsImm();
 		if (doLoad)
+		{
+			if (spilled[i] && !regs[i].location.IsImm())
+				num_reloads++;
 			LoadRegister(i, xr);
+		}
+		spilled[i] = false;
 		for (size_t j = 0; j < regs.size(); j++)
 		{
 			if (i != j && regs[j].location.IsSimpleReg() && regs[j].location.GetSimpleReg() == xr)
@@ -49,6 +49,11 @@ protected:
 
 	Gen::XEmitter *emit;
 
+	// Stores and loads caused by running out of host registers in the current block.
+	u32 num_spills;
+	u32 num_reloads;
+	BitSet32 spilled;
+
 	float ScoreRegister(Gen::X64Reg xreg);
 
 public:
@@ -127,6 +132,9 @@ public:
 
 	Gen::X64Reg GetFreeXReg();
 	int NumFreeRegisters();
+
+	u32 NumSpills() const { return num_spills; }
+	u32 NumReloads() const { return num_reloads; }
 };
 
 class GPRRegCache : public RegCache
@@ -60,8 +60,9 @@ void Jit64::bx(UGeckoInstruction inst)
 	JITDISABLE(bJITBranchOff);
 
 	// We must always process the following sentence
-	// even if the blocks are merged by PPCAnalyst::Flatten().
-	if (inst.LK)
+	// even if the blocks are merged by PPCAnalyst::Flatten(),
+	// unless nothing can see LR before the callee's blr has been followed back.
+	if (inst.LK && (js.op->wantsLR || SConfig::GetInstance().m_LocalCoreStartupParameter.bEnableDebugging))
 		MOV(32, PPCSTATE_LR, Imm32(js.compilerPC + 4));
 
 	// If this is not the last instruction of a block,
@@ -80,6 +81,12 @@ void Jit64::bx(UGeckoInstruction inst)
 		destination = SignExt26(inst.LI << 2);
 	else
 		destination = js.compilerPC + SignExt26(inst.LI << 2);
+	if (js.op->branchIsIdleLoop && SConfig::GetInstance().m_LocalCoreStartupParameter.bSkipIdle &&
+	    PowerPC::GetState() != PowerPC::CPU_STEPPING)
+	{
+		WriteIdleExit(destination);
+		return;
+	}
 #ifdef ACID_TEST
 	if (inst.LK)
 		AND(32, PPCSTATE(cr), Imm32(~(0xFF000000)));
@@ -133,7 +140,15 @@ void Jit64::bcx(UGeckoInstruction inst)
 
 	gpr.Flush(FLUSH_MAINTAIN_STATE);
 	fpr.Flush(FLUSH_MAINTAIN_STATE);
-	WriteExit(destination, inst.LK, js.compilerPC + 4);
+	if (js.op->branchIsIdleLoop && SConfig::GetInstance().m_LocalCoreStartupParameter.bSkipIdle &&
+	    PowerPC::GetState() != PowerPC::CPU_STEPPING)
+	{
+		WriteIdleExit(destination);
+	}
+	else
+	{
+		WriteExit(destination, inst.LK, js.compilerPC + 4);
+	}
 
 	if ((inst.BO & BO_DONT_CHECK_CONDITION) == 0)
 		SetJumpTarget( pConditionDontBranch );
@@ -205,6 +220,15 @@ void Jit64::bclrx(UGeckoInstruction inst)
 	INSTRUCTION_START
 	JITDISABLE(bJITBranchOff);
 
+	// An unconditional blr that isn't the last instruction returns to a bl that
+	// PPCAnalyst followed, so execution simply continues at the return address.
+	if (!js.isLastInstruction && (inst.BO & BO_DONT_DECREMENT_FLAG) && (inst.BO & BO_DONT_CHECK_CONDITION))
+	{
+		if (inst.LK && (js.op->wantsLR || SConfig::GetInstance().m_LocalCoreStartupParameter.bEnableDebugging))
+			MOV(32, PPCSTATE_LR, Imm32(js.compilerPC + 4));
+		return;
+	}
+
 	FixupBranch pCTRDontBranch;
 	if ((inst.BO & BO_DONT_DECREMENT_FLAG) == 0)  // Decrement and test CTR
 	{
@@ -232,14 +256,20 @@ void Jit64::bclrx(UGeckoInstruction inst)
 	// We don't have to do this because WriteBLRExit handles it for us. Specifically, since we only ever push
 	// divisible-by-four instruction addresses onto the stack, if the return address matches, we're already
 	// good. If it doesn't match, the mispredicted-BLR code handles the fixup.
-	if (!m_enable_blr_optimization)
+	if (!m_enable_blr_optimization || inst.LK)
 		AND(32, R(RSCRATCH), Imm32(0xFFFFFFFC));
 	if (inst.LK)
 		MOV(32, PPCSTATE_LR, Imm32(js.compilerPC + 4));
 
 	gpr.Flush(FLUSH_MAINTAIN_STATE);
 	fpr.Flush(FLUSH_MAINTAIN_STATE);
-	WriteBLRExit();
+	// blrl calls through a function pointer rather than returning, so predict
+	// the return from the callee like any other bl instead of mispredicting
+	// this one.
+	if (inst.LK)
+		WriteExitDestInRSCRATCH(true, js.compilerPC + 4);
+	else
+		WriteBLRExit();
 
 	if ((inst.BO & BO_DONT_CHECK_CONDITION) == 0)
 		SetJumpTarget( pConditionDontBranch );
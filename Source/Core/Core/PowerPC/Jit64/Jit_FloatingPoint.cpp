@@ -59,8 +59,8 @@ void Jit64::fp_tri_op(int d, int a, int b, bool reversible, bool single, void (X
 void Jit64::SetFPRFIfNeeded(UGeckoInstruction inst, X64Reg xmm)
 {
 	// As far as we know, the games that use this flag only need FPRF for fmul and fmadd, but
-	// FPRF is fast enough in JIT that we might as well just enable it for every float instruction
-	// if the FPRF flag is set.
+	// FPRF is cheap enough in JIT (it's only classified when something reads it) that we might
+	// as well just enable it for every float instruction if the FPRF flag is set.
 	if (SConfig::GetInstance().m_LocalCoreStartupParameter.bFPRF && js.op->wantsFPRF)
 		SetFPRF(xmm);
 }
@@ -189,12 +189,22 @@ void Jit64::fmaddXX(UGeckoInstruction inst)
 	else
 	{
 		if (single && round_input)
+		{
 			Force25BitPrecision(XMM0, fpr.R(c), XMM1);
+			if (packed)
+				MULPD(XMM0, fpr.R(a));
+			else
+				MULSD(XMM0, fpr.R(a));
+		}
 		else
-			MOVAPD(XMM0, fpr.R(c));
+		{
+			if (packed)
+				avx_op(&XEmitter::VMULPD, &XEmitter::MULPD, XMM0, fpr.R(c), fpr.R(a), true, true);
+			else
+				avx_op(&XEmitter::VMULSD, &XEmitter::MULSD, XMM0, fpr.R(c), fpr.R(a), true, true);
+		}
 		if (packed)
 		{
-			MULPD(XMM0, fpr.R(a));
 			if (inst.SUBOP5 == 28) //msub
 				SUBPD(XMM0, fpr.R(b));
 			else                   //(n)madd
@@ -202,7 +212,6 @@ void Jit64::fmaddXX(UGeckoInstruction inst)
 		}
 		else
 		{
-			MULSD(XMM0, fpr.R(a));
 			if (inst.SUBOP5 == 28)
 				SUBSD(XMM0, fpr.R(b));
 			else
@@ -279,13 +288,17 @@ void Jit64::fselx(UGeckoInstruction inst)
 	int c = inst.FC;
 
 	fpr.Lock(a, b, c, d);
-	MOVAPD(XMM1, fpr.R(a));
 	PXOR(XMM0, R(XMM0));
 	// This condition is very tricky; there's only one right way to handle both the case of
 	// negative/positive zero and NaN properly.
 	// (a >= -0.0 ? c : b) transforms into (0 > a ? b : c), hence the NLE.
-	CMPSD(XMM0, R(XMM1), NLE);
-	if (cpu_info.bSSE4_1)
+	CMPSD(XMM0, fpr.R(a), NLE);
+	if (cpu_info.bAVX)
+	{
+		fpr.BindToRegister(c, true, false);
+		VBLENDVPD(XMM1, fpr.RX(c), fpr.R(b), XMM0);
+	}
+	else if (cpu_info.bSSE4_1)
 	{
 		MOVAPD(XMM1, fpr.R(c));
 		BLENDVPD(XMM1, fpr.R(b));
@@ -360,8 +373,12 @@ void Jit64::FloatCompare(UGeckoInstruction inst, bool upper)
 	fpr.Lock(a, b);
 	fpr.BindToRegister(b, true, false);
 
+	// This replaces all of FPRF, so a result that's still waiting to be classified is dead.
 	if (fprf)
+	{
 		AND(32, PPCSTATE(fpscr), Imm32(~FPRF_MASK));
+		MOV(8, PPCSTATE(fprf_pending), Imm8(0));
+	}
 
 	if (upper)
 	{
@@ -131,6 +131,10 @@ void Jit64::FinalizeCarryOverflow(bool oe, bool inv)
 void Jit64::ComputeRC(const Gen::OpArg & arg, bool needs_test, bool needs_sext)
 {
 	_assert_msg_(DYNA_REC, arg.IsSimpleReg() || arg.IsImm(), "Invalid ComputeRC operand");
+	// Nothing can see CR0 before it gets overwritten again, so don't bother storing it.
+	// Merging with a branch implies the result is wanted.
+	if (!js.op->wantsCR0 && !SConfig::GetInstance().m_LocalCoreStartupParameter.bEnableDebugging)
+		return;
 	if (arg.IsImm())
 	{
 		MOV(64, PPCSTATE(cr_val[0]), Imm32((s32)arg.offset));
@@ -1437,7 +1441,11 @@ void Jit64::rlwinmx(UGeckoInstruction inst)
 		}
 		else
 		{
-			if (a != s)
+			// BMI2 can rotate into a different register without a copy first.
+			bool use_rorx = cpu_info.bBMI2 && a != s && inst.SH != 0 && !left_shift && !right_shift;
+			if (use_rorx)
+				RORX(32, gpr.RX(a), gpr.R(s), 32 - inst.SH);
+			else if (a != s)
 				MOV(32, gpr.R(a), gpr.R(s));
 
 			if (left_shift)
@@ -1451,7 +1459,7 @@ void Jit64::rlwinmx(UGeckoInstruction inst)
 			}
 			else
 			{
-				if (inst.SH != 0)
+				if (inst.SH != 0 && !use_rorx)
 					ROL(32, gpr.R(a), Imm8(inst.SH));
 				if (!(inst.MB == 0 && inst.ME == 31))
 				{
@@ -1498,10 +1506,17 @@ void Jit64::rlwimix(UGeckoInstruction inst)
 		else if (mask == 0xFFFFFFFF)
 		{
 			gpr.BindToRegister(a, a == s, true);
-			if (a != s)
-				MOV(32, gpr.R(a), gpr.R(s));
-			if (inst.SH)
-				ROL(32, gpr.R(a), Imm8(inst.SH));
+			if (cpu_info.bBMI2 && a != s && inst.SH)
+			{
+				RORX(32, gpr.RX(a), gpr.R(s), 32 - inst.SH);
+			}
+			else
+			{
+				if (a != s)
+					MOV(32, gpr.R(a), gpr.R(s));
+				if (inst.SH)
+					ROL(32, gpr.R(a), Imm8(inst.SH));
+			}
 			needs_test = true;
 		}
 		else if(gpr.R(s).IsImm())
@@ -1514,21 +1529,29 @@ void Jit64::rlwimix(UGeckoInstruction inst)
 		{
 			bool isLeftShift = mask == 0U - (1U << inst.SH);
 			bool isRightShift = mask == (1U << inst.SH) - 1;
+			bool use_rorx = cpu_info.bBMI2 && !isLeftShift && !isRightShift;
 			if (gpr.R(a).IsImm())
 			{
 				u32 maskA = gpr.R(a).offset & ~mask;
 				gpr.BindToRegister(a, false, true);
-				MOV(32, gpr.R(a), gpr.R(s));
-				if (isLeftShift)
+				if (use_rorx)
 				{
+					RORX(32, gpr.RX(a), gpr.R(s), 32 - inst.SH);
+					AND(32, gpr.R(a), Imm32(mask));
+				}
+				else if (isLeftShift)
+				{
+					MOV(32, gpr.R(a), gpr.R(s));
 					SHL(32, gpr.R(a), Imm8(inst.SH));
 				}
 				else if (isRightShift)
 				{
+					MOV(32, gpr.R(a), gpr.R(s));
 					SHR(32, gpr.R(a), Imm8(32 - inst.SH));
 				}
 				else
 				{
+					MOV(32, gpr.R(a), gpr.R(s));
 					ROL(32, gpr.R(a), Imm8(inst.SH));
 					AND(32, gpr.R(a), Imm32(mask));
 				}
@@ -1538,7 +1561,10 @@ void Jit64::rlwimix(UGeckoInstruction inst)
 			{
 				// TODO: common cases of this might be faster with pinsrb or abuse of AH
 				gpr.BindToRegister(a, true, true);
-				MOV(32, R(RSCRATCH), gpr.R(s));
+				if (use_rorx)
+					RORX(32, RSCRATCH, gpr.R(s), 32 - inst.SH);
+				else
+					MOV(32, R(RSCRATCH), gpr.R(s));
 				if (isLeftShift)
 				{
 					SHL(32, R(RSCRATCH), Imm8(inst.SH));
@@ -1553,7 +1579,8 @@ void Jit64::rlwimix(UGeckoInstruction inst)
 				}
 				else
 				{
-					ROL(32, R(RSCRATCH), Imm8(inst.SH));
+					if (!use_rorx)
+						ROL(32, R(RSCRATCH), Imm8(inst.SH));
 					XOR(32, R(RSCRATCH), gpr.R(a));
 					AndWithMask(RSCRATCH, mask);
 					XOR(32, gpr.R(a), R(RSCRATCH));
@@ -1649,6 +1676,16 @@ void Jit64::srwx(UGeckoInstruction inst)
 		u32 amount = (u32)gpr.R(b).offset;
 		gpr.SetImmediate32(a, (amount & 0x20) ? 0 : ((u32)gpr.R(s).offset >> (amount & 0x1f)));
 	}
+	else if (cpu_info.bBMI2)
+	{
+		gpr.Lock(a, b, s);
+		gpr.BindToRegister(b, true, false);
+		gpr.BindToRegister(s, true, false);
+		gpr.BindToRegister(a, a == b || a == s, true);
+		// SHRX doesn't need the amount in ECX. Shifting the zero-extended 64-bit value also
+		// takes care of amounts of 32 and up, since the count is masked to 6 bits.
+		SHRX(64, gpr.RX(a), gpr.R(s), gpr.RX(b));
+	}
 	else
 	{
 		// no register choice
@@ -1686,14 +1723,25 @@ void Jit64::slwx(UGeckoInstruction inst)
 	}
 	else
 	{
-		// no register choice
-		gpr.FlushLockX(ECX);
-		gpr.Lock(a, b, s);
-		MOV(32, R(ECX), gpr.R(b));
-		gpr.BindToRegister(a, a == s, true);
-		if (a != s)
-			MOV(32, gpr.R(a), gpr.R(s));
-		SHL(64, gpr.R(a), R(ECX));
+		if (cpu_info.bBMI2)
+		{
+			gpr.Lock(a, b, s);
+			gpr.BindToRegister(b, true, false);
+			gpr.BindToRegister(s, true, false);
+			gpr.BindToRegister(a, a == b || a == s, true);
+			SHLX(64, gpr.RX(a), gpr.R(s), gpr.RX(b));
+		}
+		else
+		{
+			// no register choice
+			gpr.FlushLockX(ECX);
+			gpr.Lock(a, b, s);
+			MOV(32, R(ECX), gpr.R(b));
+			gpr.BindToRegister(a, a == s, true);
+			if (a != s)
+				MOV(32, gpr.R(a), gpr.R(s));
+			SHL(64, gpr.R(a), R(ECX));
+		}
 		if (inst.Rc)
 		{
 			AND(32, gpr.R(a), gpr.R(a));
@@ -106,51 +106,6 @@ void Jit64::lXXx(UGeckoInstruction inst)
 		}
 	}
 
-	// TODO(ector): Make it dynamically enable/disable idle skipping where appropriate
-	// Will give nice boost to dual core mode
-	// (mb2): I agree,
-	// IMHO those Idles should always be skipped and replaced by a more controllable "native" Idle methode
-	// ... maybe the throttle one already do that :p
-	if (SConfig::GetInstance().m_LocalCoreStartupParameter.bSkipIdle &&
-	    PowerPC::GetState() != PowerPC::CPU_STEPPING &&
-	    inst.OPCD == 32 &&
-	    (inst.hex & 0xFFFF0000) == 0x800D0000 &&
-	    (Memory::ReadUnchecked_U32(js.compilerPC + 4) == 0x28000000 ||
-	    (SConfig::GetInstance().m_LocalCoreStartupParameter.bWii && Memory::ReadUnchecked_U32(js.compilerPC + 4) == 0x2C000000)) &&
-	    Memory::ReadUnchecked_U32(js.compilerPC + 8) == 0x4182fff8)
-	{
-		// TODO(LinesPrower):
-		// - Rewrite this!
-		// It seems to be ugly and inefficient, but I don't know JIT stuff enough to make it right
-		// It only demonstrates the idea
-
-		// do our job at first
-		s32 offset = (s32)(s16)inst.SIMM_16;
-		gpr.BindToRegister(a, true, false);
-		gpr.BindToRegister(d, false, true);
-		SafeLoadToReg(gpr.RX(d), gpr.R(a), accessSize, offset, CallerSavedRegistersInUse(), signExtend);
-
-		// if it's still 0, we can wait until the next event
-		TEST(32, gpr.R(d), gpr.R(d));
-		FixupBranch noIdle = J_CC(CC_NZ);
-
-		BitSet32 registersInUse = CallerSavedRegistersInUse();
-		ABI_PushRegistersAndAdjustStack(registersInUse, 0);
-
-		ABI_CallFunctionC((void *)&PowerPC::OnIdle, PowerPC::ppcState.gpr[a] + (s32)(s16)inst.SIMM_16);
-
-		ABI_PopRegistersAndAdjustStack(registersInUse, 0);
-
-		// ! we must continue executing of the loop after exception handling, maybe there is still 0 in r0
-		//MOV(32, PPCSTATE(pc), Imm32(js.compilerPC));
-		WriteExceptionExit();
-
-		SetJumpTarget(noIdle);
-
-		//js.compilerPC += 8;
-		return;
-	}
-
 	// Determine whether this instruction updates inst.RA
 	bool update;
 	if (inst.OPCD == 31)
@@ -293,6 +248,8 @@ void Jit64::dcbz(UGeckoInstruction inst)
 	JITDISABLE(bJITLoadStoreOff);
 	if (SConfig::GetInstance().m_LocalCoreStartupParameter.bDCBZOFF)
 		return;
+	// The fast path can't be backpatched if it hits a page protected for memchecks.
+	FALLBACK_IF(PowerPC::memchecks.HasAny());
 
 	int a = inst.RA;
 	int b = inst.RB;
@@ -20,7 +20,9 @@ void Jit64::psq_stXX(UGeckoInstruction inst)
 {
 	INSTRUCTION_START
 	JITDISABLE(bJITLoadStorePairedOff);
-	FALLBACK_IF(!inst.RA);
+	// The quantized load and store routines access RAM directly and can't be
+	// backpatched if they hit a page protected for memchecks.
+	FALLBACK_IF(!inst.RA || PowerPC::memchecks.HasAny());
 
 	s32 offset = inst.SIMM_12;
 	bool indexed = inst.OPCD == 4;
@@ -93,7 +95,7 @@ void Jit64::psq_lXX(UGeckoInstruction inst)
 {
 	INSTRUCTION_START
 	JITDISABLE(bJITLoadStorePairedOff);
-	FALLBACK_IF(!inst.RA);
+	FALLBACK_IF(!inst.RA || PowerPC::memchecks.HasAny());
 
 	s32 offset = inst.SIMM_12;
 	bool indexed = inst.OPCD == 4;
@@ -41,24 +41,36 @@ void Jit64::ps_sel(UGeckoInstruction inst)
 
 	fpr.Lock(a, b, c, d);
 
-	if (cpu_info.bSSE4_1)
+	if (cpu_info.bAVX)
 	{
 		PXOR(XMM0, R(XMM0));
 		CMPPD(XMM0, fpr.R(a), NLE);
-		MOVAPD(XMM1, fpr.R(c));
-		BLENDVPD(XMM1, fpr.R(b));
+		// Blend straight into d rather than building the result in a temporary.
+		fpr.BindToRegister(c, true, false);
+		fpr.BindToRegister(d, d == b || d == c);
+		VBLENDVPD(fpr.RX(d), fpr.RX(c), fpr.R(b), XMM0);
 	}
 	else
 	{
-		PXOR(XMM1, R(XMM1));
-		CMPPD(XMM1, fpr.R(a), NLE);
-		MOVAPD(XMM0, R(XMM1));
-		PAND(XMM1, fpr.R(b));
-		PANDN(XMM0, fpr.R(c));
-		POR(XMM1, R(XMM0));
+		if (cpu_info.bSSE4_1)
+		{
+			PXOR(XMM0, R(XMM0));
+			CMPPD(XMM0, fpr.R(a), NLE);
+			MOVAPD(XMM1, fpr.R(c));
+			BLENDVPD(XMM1, fpr.R(b));
+		}
+		else
+		{
+			PXOR(XMM1, R(XMM1));
+			CMPPD(XMM1, fpr.R(a), NLE);
+			MOVAPD(XMM0, R(XMM1));
+			PAND(XMM1, fpr.R(b));
+			PANDN(XMM0, fpr.R(c));
+			POR(XMM1, R(XMM0));
+		}
+		fpr.BindToRegister(d, false);
+		MOVAPD(fpr.RX(d), R(XMM1));
 	}
-	fpr.BindToRegister(d, false);
-	MOVAPD(fpr.RX(d), R(XMM1));
 	fpr.UnlockAll();
 }
 
@@ -166,8 +178,7 @@ void Jit64::ps_sum(UGeckoInstruction inst)
 	case 11:
 		MOVDDUP(XMM1, fpr.R(a));  // {a.ps0, a.ps0}
 		ADDPD(XMM1, fpr.R(b));    // {a.ps0 + b.ps0, a.ps0 + b.ps1}
-		MOVAPD(XMM0, fpr.R(c));
-		SHUFPD(XMM0, R(XMM1), 2); // {c.ps0, a.ps0 + b.ps1}
+		avx_op(&XEmitter::VSHUFPD, &XEmitter::SHUFPD, XMM0, fpr.R(c), R(XMM1), 2); // {c.ps0, a.ps0 + b.ps1}
 		break;
 	default:
 		PanicAlert("ps_sum WTF!!!");
@@ -384,9 +384,12 @@ void JitIL::WriteExit(u32 destination)
 	JitBlock *b = js.curBlock;
 	JitBlock::LinkData linkData;
 	linkData.exitAddress = destination;
-	linkData.exitPtrs = GetWritableCodePtr();
 	linkData.linkStatus = false;
 
+	// Set pc even if the exit is linked, so the block cache can unlink it again.
+	MOV(32, PPCSTATE(pc), Imm32(destination));
+	linkData.exitPtrs = GetWritableCodePtr();
+
 	// Link opportunity!
 	int block;
 	if (jo.enableBlocklink && (block = blocks.GetBlockNumberFromStartAddress(destination)) >= 0)
@@ -397,7 +400,6 @@ void JitIL::WriteExit(u32 destination)
 	}
 	else
 	{
-		MOV(32, PPCSTATE(pc), Imm32(destination));
 		JMP(asm_routines.dispatcher, true);
 	}
 	b->linkData.push_back(linkData);
@@ -15,6 +15,7 @@ JitBase *jit;
 
 void Jit(u32 em_address)
 {
+	jit->dispatcher_stats.misses++;
 	jit->Jit(em_address);
 }
 
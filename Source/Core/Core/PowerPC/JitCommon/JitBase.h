@@ -98,6 +98,16 @@ protected:
 		std::unordered_set<u32> fifoWriteAddresses;
 	};
 
+	// Updated from generated code to show how often blocks are reached without
+	// a block lookup. Logged when the JIT shuts down.
+	struct DispatcherStats
+	{
+		u64 lookups;         // block lookups done by the dispatcher
+		u64 misses;          // lookups that didn't find a compiled block
+		u64 blr_hits;        // blr that returned straight to the block after its bl
+		u64 blr_mispredicts; // blr that had to look up its destination
+	};
+
 	PPCAnalyst::CodeBlock code_block;
 	PPCAnalyst::PPCAnalyzer analyzer;
 
@@ -105,6 +115,7 @@ public:
 	// This should probably be removed from public:
 	JitOptions jo;
 	JitState js;
+	DispatcherStats dispatcher_stats;
 
 	virtual JitBaseBlockCache *GetBlockCache() = 0;
 
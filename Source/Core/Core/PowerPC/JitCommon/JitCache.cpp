@@ -9,11 +9,15 @@
 // performance hit, it's not enabled by default, but it's useful for
 // locating performance issues.
 
+#include <algorithm>
+
 #include "disasm.h"
 
 #include "Common/CommonTypes.h"
+#include "Common/JitRegister.h"
 #include "Common/MemoryUtil.h"
 #include "Core/PowerPC/JitInterface.h"
+#include "Core/PowerPC/PPCSymbolDB.h"
 #include "Core/PowerPC/JitCommon/JitBase.h"
 
 #ifdef _WIN32
@@ -34,9 +38,105 @@ op_agent_t agent;
 
 using namespace Gen;
 
+	JitLinkTable::JitLinkTable() : m_mask(0), m_shift(0), m_count(0)
+	{
+		Resize(12);
+	}
+
+	void JitLinkTable::Clear()
+	{
+		for (Entry& e : m_entries)
+			e.block_num = -1;
+		m_count = 0;
+	}
+
+	void JitLinkTable::Resize(u32 bits)
+	{
+		std::vector<Entry> old_entries;
+		old_entries.swap(m_entries);
+
+		Entry empty = { 0, -1 };
+		m_entries.assign(size_t(1) << bits, empty);
+		m_mask = (1u << bits) - 1;
+		m_shift = 32 - bits;
+		m_count = 0;
+
+		for (const Entry& e : old_entries)
+		{
+			if (e.block_num != -1)
+				Insert(e.address, e.block_num);
+		}
+	}
+
+	void JitLinkTable::Insert(u32 address, int block_num)
+	{
+		// Keep the load factor at or below 1/2 so probe sequences stay short.
+		if ((m_count + 1) * 2 > m_entries.size())
+		{
+			u32 bits = 32 - m_shift;
+			Resize(bits + 1);
+		}
+
+		u32 i = Slot(address);
+		while (m_entries[i].block_num != -1)
+			i = (i + 1) & m_mask;
+
+		m_entries[i].address = address;
+		m_entries[i].block_num = block_num;
+		m_count++;
+	}
+
+	void JitLinkTable::Erase(u32 address)
+	{
+		u32 i = Slot(address);
+		while (m_entries[i].block_num != -1)
+		{
+			// RemoveAt() shifts a later entry into slot i, so look at it again.
+			if (m_entries[i].address == address)
+				RemoveAt(i);
+			else
+				i = (i + 1) & m_mask;
+		}
+	}
+
+	void JitLinkTable::Erase(u32 address, int block_num)
+	{
+		u32 i = Slot(address);
+		while (m_entries[i].block_num != -1)
+		{
+			if (m_entries[i].address == address && m_entries[i].block_num == block_num)
+				RemoveAt(i);
+			else
+				i = (i + 1) & m_mask;
+		}
+	}
+
+	void JitLinkTable::RemoveAt(u32 i)
+	{
+		// Backward-shift deletion: pull later entries of the probe sequence into
+		// the hole, unless that would move them in front of their home slot.
+		u32 j = i;
+		while (true)
+		{
+			j = (j + 1) & m_mask;
+			if (m_entries[j].block_num == -1)
+				break;
+
+			u32 home = Slot(m_entries[j].address);
+			bool home_in_between = (i <= j) ? (i < home && home <= j) : (i < home || home <= j);
+			if (!home_in_between)
+			{
+				m_entries[i] = m_entries[j];
+				i = j;
+			}
+		}
+		m_entries[i].block_num = -1;
+		m_count--;
+	}
+
 	bool JitBaseBlockCache::IsFull() const
 	{
-		return GetNumBlocks() >= MAX_NUM_BLOCKS - 1;
+		return GetNumBlocks() >= MAX_NUM_BLOCKS - 1 && free_blocks.empty();
 	}
 
 	void JitBaseBlockCache::Init()
@@ -53,6 +153,7 @@ using namespace Gen;
 		iCache.fill(JIT_ICACHE_INVALID_BYTE);
 		iCacheEx.fill(JIT_ICACHE_INVALID_BYTE);
 		iCacheVMEM.fill(JIT_ICACHE_INVALID_BYTE);
+		block_pages.resize(NUM_BLOCK_PAGES);
 		Clear();
 
 		m_initialized = true;
@@ -86,12 +187,14 @@ using namespace Gen;
 		{
 			DestroyBlock(i, false);
 		}
-		links_to.clear();
-		block_map.clear();
+		links_to.Clear();
+		for (std::vector<int>& page : block_pages)
+			page.clear();
 
 		valid_block.ClearAll();
 
 		num_blocks = 0;
+		free_blocks.clear();
 		blockCodePointers.fill(nullptr);
 	}
 
@@ -123,14 +226,38 @@ using namespace Gen;
 			return false;
 	}
 
+	bool JitBaseBlockCache::Overlaps(const JitBlock& b, u32 start, u32 end) const
+	{
+		for (const auto& range : b.physicalRanges)
+		{
+			if (range.first <= end && range.second >= start)
+				return true;
+		}
+		return false;
+	}
+
 	int JitBaseBlockCache::AllocateBlock(u32 em_address)
 	{
-		JitBlock &b = blocks[num_blocks];
+		int block_num;
+		if (!free_blocks.empty())
+		{
+			block_num = free_blocks.back();
+			free_blocks.pop_back();
+		}
+		else
+		{
+			block_num = num_blocks;
+			num_blocks++; //commit the current block
+		}
+
+		JitBlock &b = blocks[block_num];
 		b.invalid = false;
 		b.originalAddress = em_address;
+		b.spillCount = 0;
+		b.reloadCount = 0;
 		b.linkData.clear();
-		num_blocks++; //commit the current block
-		return num_blocks - 1;
+		b.physicalRanges.clear();
+		return block_num;
 	}
 
 	void JitBaseBlockCache::FinalizeBlock(int block_num, bool block_link, const u8 *code_ptr)
@@ -140,18 +267,32 @@ using namespace Gen;
 		u32* icp = GetICachePtr(b.originalAddress);
 		*icp = block_num;
 
-		// Convert the logical address to a physical address for the block map
-		u32 pAddr = b.originalAddress & 0x1FFFFFFF;
+		if (b.physicalRanges.empty())
+		{
+			// Convert the logical address to a physical address for the block map
+			u32 pAddr = b.originalAddress & 0x1FFFFFFF;
+			// Blocks that failed to fetch their first instruction have no size, but
+			// still have to be found when their address is invalidated.
+			u32 pEnd = std::min(pAddr + 4 * std::max(b.originalSize, 1u) - 1, 0x1FFFFFFFu);
+			b.physicalRanges.push_back(std::make_pair(pAddr, pEnd));
+		}
 
-		for (u32 block = pAddr / 32; block <= (pAddr + (b.originalSize - 1) * 4) / 32; ++block)
-			valid_block.Set(block);
+		for (const auto& range : b.physicalRanges)
+		{
+			for (u32 block = range.first / 32; block <= range.second / 32; ++block)
+				valid_block.Set(block);
+
+			// A block can show up twice in a bucket if two of its ranges share a
+			// page; invalidation copes with that.
+			for (u32 page = range.first >> BLOCK_PAGE_SHIFT; page <= range.second >> BLOCK_PAGE_SHIFT; ++page)
+				block_pages[page].push_back(block_num);
+		}
 
-		block_map[std::make_pair(pAddr + 4 * b.originalSize - 1, pAddr)] = block_num;
 		if (block_link)
 		{
 			for (const auto& e : b.linkData)
 			{
-				links_to.insert(std::pair<u32, int>(e.exitAddress, block_num));
+				links_to.Insert(e.exitAddress, block_num);
 			}
 
 			LinkBlock(block_num);
@@ -179,6 +320,16 @@ using namespace Gen;
 		jmethod.method_name = b.blockName;
 		iJIT_NotifyEvent(iJVM_EVENT_TYPE_METHOD_LOAD_FINISHED, (void*)&jmethod);
 #endif
+
+		if (JitRegister::IsEnabled())
+		{
+			u32 size = (u32)(b.normalEntry - b.checkedEntry) + b.codeSize;
+			Symbol* symbol = g_symbolDB.GetSymbolFromAddr(b.originalAddress);
+			if (symbol)
+				JitRegister::Register(b.checkedEntry, size, "JIT_PPC_%s_%08x", symbol->name.c_str(), b.originalAddress);
+			else
+				JitRegister::Register(b.checkedEntry, size, "JIT_PPC_%08x", b.originalAddress);
+		}
 	}
 
 	const u8 **JitBaseBlockCache::GetCodePointers()
@@ -189,11 +340,11 @@ using namespace Gen;
 	u32* JitBaseBlockCache::GetICachePtr(u32 addr)
 	{
 		if (addr & JIT_ICACHE_VMEM_BIT)
-			return (u32*)(&jit->GetBlockCache()->iCacheVMEM[addr & JIT_ICACHE_MASK]);
+			return (u32*)(&iCacheVMEM[addr & JIT_ICACHE_MASK]);
 		else if (addr & JIT_ICACHE_EXRAM_BIT)
-			return (u32*)(&jit->GetBlockCache()->iCacheEx[addr & JIT_ICACHEEX_MASK]);
+			return (u32*)(&iCacheEx[addr & JIT_ICACHEEX_MASK]);
 		else
-			return (u32*)(&jit->GetBlockCache()->iCache[addr & JIT_ICACHE_MASK]);
+			return (u32*)(&iCache[addr & JIT_ICACHE_MASK]);
 	}
 
 	int JitBaseBlockCache::GetBlockNumberFromStartAddress(u32 addr)
@@ -248,38 +399,29 @@ using namespace Gen;
 	{
 		LinkBlockExits(i);
 		JitBlock &b = blocks[i];
-		// equal_range(b) returns pair<iterator,iterator> representing the range
-		// of element with key b
-		auto ppp = links_to.equal_range(b.originalAddress);
-
-		if (ppp.first == ppp.second)
-			return;
-
-		for (auto iter = ppp.first; iter != ppp.second; ++iter)
+		links_to.ForEach(b.originalAddress, [this](int source)
 		{
-			// PanicAlert("Linking block %i to block %i", iter->second, i);
-			LinkBlockExits(iter->second);
-		}
+			LinkBlockExits(source);
+		});
 	}
 
-	void JitBaseBlockCache::UnlinkBlock(int i)
+	void JitBaseBlockCache::UnlinkBlock(int i, bool forget_sources)
 	{
 		JitBlock &b = blocks[i];
-		auto ppp = links_to.equal_range(b.originalAddress);
-
-		if (ppp.first == ppp.second)
-			return;
-
-		for (auto iter = ppp.first; iter != ppp.second; ++iter)
+		links_to.ForEach(b.originalAddress, [this, &b](int source)
 		{
-			JitBlock &sourceBlock = blocks[iter->second];
+			JitBlock &sourceBlock = blocks[source];
 			for (auto& e : sourceBlock.linkData)
 			{
-				if (e.exitAddress == b.originalAddress)
+				if (e.exitAddress == b.originalAddress && e.linkStatus)
+				{
+					WriteUnlinkBlock(e.exitPtrs);
 					e.linkStatus = false;
+				}
 			}
-		}
-		links_to.erase(b.originalAddress);
+		});
+		if (forget_sources)
+			links_to.Erase(b.originalAddress);
 	}
 
 	void JitBaseBlockCache::DestroyBlock(int block_num, bool invalidate)
@@ -299,7 +441,7 @@ using namespace Gen;
 		b.invalid = true;
 		*GetICachePtr(b.originalAddress) = JIT_ICACHE_INVALID_WORD;
 
-		UnlinkBlock(block_num);
+		UnlinkBlock(block_num, true);
 
 		// Send anyone who tries to run this block back to the dispatcher.
 		// Not entirely ideal, but .. pretty good.
@@ -307,6 +449,41 @@ using namespace Gen;
 		WriteDestroyBlock(b.checkedEntry, b.originalAddress);
 	}
 
+	void JitBaseBlockCache::DestroyBlockForRecompile(int block_num)
+	{
+		JitBlock &b = blocks[block_num];
+		if (b.invalid)
+			return;
+		b.invalid = true;
+		*GetICachePtr(b.originalAddress) = JIT_ICACHE_INVALID_WORD;
+
+		UnlinkBlock(block_num, false);
+
+		WriteDestroyBlock(b.checkedEntry, b.originalAddress);
+	}
+
+	void JitBaseBlockCache::FreeBlock(int block_num)
+	{
+		JitBlock &b = blocks[block_num];
+		if (!b.normalEntry)
+			return; // already freed
+
+		if (!b.invalid)
+			DestroyBlock(block_num, false);
+
+		// Blocks that get this number later must not be linked through the
+		// exits of this one. Stale page buckets are harmless; they are checked
+		// against the ranges of whatever block has the number now.
+		for (const auto& e : b.linkData)
+			links_to.Erase(e.exitAddress, block_num);
+		b.linkData.clear();
+		b.checkedEntry = nullptr;
+		b.normalEntry = nullptr;
+		blockCodePointers[block_num] = nullptr;
+
+		free_blocks.push_back(block_num);
+	}
+
 	void JitBaseBlockCache::InvalidateICache(u32 address, const u32 length, bool forced)
 	{
 		// Convert the logical address to a physical address for the block map
@@ -323,20 +500,34 @@ using namespace Gen;
 		}
 
 		// destroy JIT blocks
-		// !! this works correctly under assumption that any two overlapping blocks end at the same address
-		if (destroy_block)
+		if (destroy_block && length != 0)
 		{
-			std::map<std::pair<u32,u32>, u32>::iterator it1 = block_map.lower_bound(std::make_pair(pAddr, 0)), it2 = it1;
-			while (it2 != block_map.end() && it2->first.second < pAddr + length)
-			{
-				JitBlock &b = blocks[it2->second];
-				*GetICachePtr(b.originalAddress) = JIT_ICACHE_INVALID_WORD;
-				DestroyBlock(it2->second, true);
-				++it2;
-			}
-			if (it1 != it2)
+			u32 pEnd = (u32)std::min<u64>((u64)pAddr + length - 1, 0x1FFFFFFF);
+			for (u32 page = pAddr >> BLOCK_PAGE_SHIFT; page <= pEnd >> BLOCK_PAGE_SHIFT; ++page)
 			{
-				block_map.erase(it1, it2);
+				std::vector<int>& bucket = block_pages[page];
+				for (size_t i = 0; i < bucket.size();)
+				{
+					JitBlock &b = blocks[bucket[i]];
+
+					// Blocks that span several pages are only removed from the
+					// other pages' buckets once those are looked at.
+					if (!b.invalid && Overlaps(b, pAddr, pEnd))
+					{
+						*GetICachePtr(b.originalAddress) = JIT_ICACHE_INVALID_WORD;
+						DestroyBlock(bucket[i], true);
+					}
+
+					if (b.invalid)
+					{
+						bucket[i] = bucket.back();
+						bucket.pop_back();
+					}
+					else
+					{
+						++i;
+					}
+				}
 			}
 
 			// If the code was actually modified, we need to clear the relevant entries from the
@@ -360,6 +551,12 @@ using namespace Gen;
 			emit.JMP(address, true);
 	}
 
+	void JitBlockCache::WriteUnlinkBlock(u8* location)
+	{
+		// Exits set pc before jumping, linked or not.
+		WriteLinkBlock(location, jit->GetAsmRoutines()->dispatcher);
+	}
+
 	void JitBlockCache::WriteDestroyBlock(const u8* location, u32 address)
 	{
 		XEmitter emit((u8 *)location);
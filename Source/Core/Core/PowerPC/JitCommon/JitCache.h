@@ -6,8 +6,8 @@
 
 #include <array>
 #include <bitset>
-#include <map>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "Core/PowerPC/Gekko.h"
@@ -40,6 +40,14 @@ struct JitBlock
 	u32 codeSize;
 	u32 originalSize;
 	int runCount;  // for profiling.
+	u32 tierUpCounter; // executions left until the block is recompiled as hot
+	u32 spillCount;  // register cache stores/loads due to running out of
+	u32 reloadCount; // host registers, for profiling.
+
+	// Inclusive physical address ranges of the guest code the block was built
+	// from. Filled in by FinalizeBlock() from originalAddress/originalSize
+	// unless the JIT followed branches and set it up itself.
+	std::vector<std::pair<u32, u32>> physicalRanges;
 
 	bool invalid;
 
@@ -103,30 +111,85 @@ public:
 	}
 };
 
+// Open-addressed multimap from a guest address to the numbers of the blocks
+// that have an exit to it. Blocks are linked and unlinked constantly in games
+// that keep loading new code, and a node-based std::multimap spends most of
+// that time allocating and chasing pointers.
+class JitLinkTable final
+{
+public:
+	JitLinkTable();
+
+	void Clear();
+	void Insert(u32 address, int block_num);
+	// Removes every entry for this address.
+	void Erase(u32 address);
+	// Removes the entries for this address that belong to one block.
+	void Erase(u32 address, int block_num);
+
+	template <typename Func>
+	void ForEach(u32 address, Func func) const
+	{
+		for (u32 i = Slot(address); m_entries[i].block_num != -1; i = (i + 1) & m_mask)
+		{
+			if (m_entries[i].address == address)
+				func(m_entries[i].block_num);
+		}
+	}
+
+private:
+	struct Entry
+	{
+		u32 address;
+		int block_num; // -1 if the slot is empty
+	};
+
+	u32 Slot(u32 address) const { return ((address >> 2) * 0x9E3779B1u) >> m_shift; }
+	void RemoveAt(u32 i);
+	void Resize(u32 bits);
+
+	std::vector<Entry> m_entries;
+	u32 m_mask;
+	u32 m_shift;
+	u32 m_count;
+};
+
 class JitBaseBlockCache
 {
 	enum
 	{
 		MAX_NUM_BLOCKS = 65536 * 2,
+
+		// Blocks are bucketed by the 4 KiB pages of physical memory they
+		// overlap, so invalidating a range only has to look at the blocks
+		// that are actually near it.
+		BLOCK_PAGE_SHIFT = 12,
+		NUM_BLOCK_PAGES = 0x20000000 >> BLOCK_PAGE_SHIFT,
 	};
 
 	std::array<const u8*, MAX_NUM_BLOCKS> blockCodePointers;
 	std::array<JitBlock, MAX_NUM_BLOCKS> blocks;
 	int num_blocks;
-	std::multimap<u32, int> links_to;
-	std::map<std::pair<u32,u32>, u32> block_map; // (end_addr, start_addr) -> number
+	// Numbers of freed blocks, which AllocateBlock() hands out again.
+	std::vector<int> free_blocks;
+	JitLinkTable links_to;
+	std::vector<std::vector<int>> block_pages;
 	ValidBlockBitSet valid_block;
 
 	bool m_initialized;
 
 	bool RangeIntersect(int s1, int e1, int s2, int e2) const;
+	bool Overlaps(const JitBlock& b, u32 start, u32 end) const;
 	void LinkBlockExits(int i);
 	void LinkBlock(int i);
-	void UnlinkBlock(int i);
+	void UnlinkBlock(int i, bool forget_sources);
 
 	// Virtual for overloaded
 	virtual void WriteLinkBlock(u8* location, const u8* address) = 0;
 	virtual void WriteDestroyBlock(const u8* location, u32 address) = 0;
+	// Points a linked exit back at the dispatcher. JITs that never reuse the
+	// code of destroyed blocks can leave it jumping to the destroyed block.
+	virtual void WriteUnlinkBlock(u8* location) {}
 
 public:
 	JitBaseBlockCache() : num_blocks(0), m_initialized(false)
@@ -159,9 +222,15 @@ public:
 	u32 GetOriginalFirstOp(int block_num);
 	CompiledCode GetCompiledCodeFromBlock(int block_num);
 
-	// DOES NOT WORK CORRECTLY WITH INLINING
 	void InvalidateICache(u32 address, const u32 length, bool forced);
 	void DestroyBlock(int block_num, bool invalidate);
+	// Destroys a block that is about to be compiled again from the same guest
+	// code. Blocks linking to it stay registered, so they are relinked to the
+	// replacement when it is finalized.
+	void DestroyBlockForRecompile(int block_num);
+	// Destroys a block if it is still alive and lets its number be reused.
+	// Only safe once nothing can reach its code, which is then up for reuse.
+	void FreeBlock(int block_num);
 };
 
 // x86 BlockCache
@@ -170,4 +239,5 @@ class JitBlockCache : public JitBaseBlockCache
 private:
 	void WriteLinkBlock(u8* location, const u8* address) override;
 	void WriteDestroyBlock(const u8* location, u32 address) override;
+	void WriteUnlinkBlock(u8* location) override;
 };
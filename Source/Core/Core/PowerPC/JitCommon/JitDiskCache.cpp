@@ -0,0 +1,124 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include "Common/FileUtil.h"
+#include "Common/Hash.h"
+#include "Common/StringUtil.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PowerPC/JitCommon/JitDiskCache.h"
+
+class JitDiskCache::Reader : public LinearDiskCacheReader<BlockKey, u8>
+{
+public:
+	Reader(JitDiskCache* cache) : m_cache(cache) {}
+
+	void Read(const BlockKey& key, const u8* value, u32 value_size) override
+	{
+		if (m_cache->m_known.insert(std::make_pair(key.address, key.hash)).second)
+			m_cache->m_pending.emplace(key.address, key);
+	}
+
+private:
+	JitDiskCache* m_cache;
+};
+
+void JitDiskCache::Init(const std::string& game_id)
+{
+	Shutdown();
+
+	if (game_id.empty())
+		return;
+
+	std::string cache_dir = File::GetUserPath(D_CACHE_IDX);
+	if (!File::Exists(cache_dir))
+		File::CreateDir(cache_dir);
+
+	std::string filename = StringFromFormat("%sjit-%s-blocks.cache", cache_dir.c_str(), game_id.c_str());
+	Reader reader(this);
+	u32 num_read = m_file.OpenAndRead(filename, reader);
+	INFO_LOG(DYNA_REC, "JIT disk cache: %u blocks recorded for %s", num_read, game_id.c_str());
+
+	m_enabled = true;
+}
+
+void JitDiskCache::Shutdown()
+{
+	if (m_enabled)
+	{
+		m_file.Sync();
+		m_file.Close();
+	}
+	m_known.clear();
+	m_pending.clear();
+	m_enabled = false;
+}
+
+bool JitDiskCache::HashGuestCode(u32 address, u32 num_instructions, u64* hash)
+{
+	if (num_instructions == 0)
+		return false;
+
+	u32 end = address + 4 * (num_instructions - 1);
+	if (!Memory::IsRAMAddress(address) || !Memory::IsRAMAddress(end))
+		return false;
+
+	// Both ends being in RAM isn't enough if the range crosses into another
+	// mirror or region.
+	if ((address >> 28) != (end >> 28))
+		return false;
+
+	// Always use MurmurHash3 directly, since GetHash64 changes implementation
+	// depending on the video settings and this needs to be stable across runs.
+	*hash = GetMurmurHash3(Memory::GetPointer(address), 4 * num_instructions, 0);
+	return true;
+}
+
+void JitDiskCache::AddBlock(u32 address, u32 num_instructions)
+{
+	if (!m_enabled)
+		return;
+
+	BlockKey key;
+	key.address = address;
+	key.num_instructions = num_instructions;
+	if (!HashGuestCode(address, num_instructions, &key.hash))
+		return;
+
+	if (m_known.insert(std::make_pair(key.address, key.hash)).second)
+		m_file.Append(key, nullptr, 0);
+}
+
+bool JitDiskCache::IsPendingAndValid(u32 address) const
+{
+	auto range = m_pending.equal_range(address);
+	for (auto it = range.first; it != range.second; ++it)
+	{
+		u64 hash;
+		if (HashGuestCode(address, it->second.num_instructions, &hash) && hash == it->second.hash)
+			return true;
+	}
+	return false;
+}
+
+std::vector<JitDiskCache::BlockKey> JitDiskCache::TakeValidBlocks()
+{
+	std::vector<BlockKey> valid;
+
+	for (auto it = m_pending.begin(); it != m_pending.end();)
+	{
+		const BlockKey& key = it->second;
+		u64 hash;
+		if (HashGuestCode(key.address, key.num_instructions, &hash) && hash == key.hash)
+		{
+			valid.push_back(key);
+			it = m_pending.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+
+	return valid;
+}
@@ -0,0 +1,64 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/LinearDiskCache.h"
+
+// Remembers which guest blocks a title has run in earlier sessions so the JIT
+// can translate them up front, instead of one at a time while the game runs.
+//
+// The generated host code itself isn't stored. Blocks contain absolute
+// pointers into the dispatcher, the far code region and the trampoline cache,
+// so they aren't relocatable between runs. What we store is the start address
+// of each block plus a hash of the guest instructions it was made of, which is
+// enough to tell whether that exact code is sitting in guest memory again.
+class JitDiskCache
+{
+public:
+	struct BlockKey
+	{
+		u32 address;
+		u32 num_instructions;
+		u64 hash;
+	};
+
+	JitDiskCache() : m_enabled(false) {}
+
+	void Init(const std::string& game_id);
+	void Shutdown();
+
+	bool IsEnabled() const { return m_enabled; }
+
+	// Records a block that has just been compiled, unless it is already known.
+	void AddBlock(u32 address, u32 num_instructions);
+
+	// Returns true if a block recorded in the cache starts at this address, has
+	// not been precompiled yet, and its instructions are in guest memory now.
+	bool IsPendingAndValid(u32 address) const;
+
+	// Removes and returns the pending blocks whose instructions are currently
+	// present, unmodified, in guest memory. Blocks that don't match yet (e.g.
+	// because the REL containing them hasn't been loaded) stay pending.
+	std::vector<BlockKey> TakeValidBlocks();
+
+	// Hash of the guest instructions in [address, address + 4 * num_instructions).
+	// Returns false if the range isn't backed by RAM.
+	static bool HashGuestCode(u32 address, u32 num_instructions, u64* hash);
+
+private:
+	class Reader;
+
+	LinearDiskCache<BlockKey, u8> m_file;
+	std::set<std::pair<u32, u64>> m_known;
+	std::multimap<u32, BlockKey> m_pending;
+	bool m_enabled;
+};
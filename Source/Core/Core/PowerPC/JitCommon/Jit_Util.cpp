@@ -2,11 +2,13 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <cstddef>
 #include <emmintrin.h>
 
 #include "Common/CommonTypes.h"
 #include "Common/MathUtil.h"
 
+#include "Core/HW/Memmap.h"
 #include "Core/HW/MMIO.h"
 #include "Core/PowerPC/JitCommon/Jit_Util.h"
 #include "Core/PowerPC/JitCommon/JitBase.h"
@@ -220,10 +222,102 @@ private:
 	bool m_sign_extend;
 };
 
+// Visitor that generates code to write a MMIO value.
+template <typename T>
+class MMIOWriteCodeGenerator : public MMIO::WriteHandlingMethodVisitor<T>
+{
+public:
+	MMIOWriteCodeGenerator(Gen::X64CodeBlock* code, BitSet32 registers_in_use,
+	                       Gen::OpArg value, u32 address, u32 pc)
+		: m_code(code), m_registers_in_use(registers_in_use), m_value(value),
+		  m_address(address), m_pc(pc), m_calls_handler(false)
+	{
+	}
+
+	virtual void VisitNop()
+	{
+	}
+	virtual void VisitDirect(T* addr, u32 mask)
+	{
+		StoreToAddrMask(8 * sizeof (T), addr, mask);
+	}
+	virtual void VisitComplex(const std::function<void(u32, T)>* lambda)
+	{
+		CallLambda(8 * sizeof (T), lambda);
+	}
+
+	bool CallsHandler() const { return m_calls_handler; }
+
+private:
+	// RSCRATCH is free to use for the value, RSCRATCH2 holds the pointer.
+	void StoreToAddrMask(int sbits, void* ptr, u32 mask)
+	{
+		m_code->MOV(64, R(RSCRATCH2), ImmPtr(ptr));
+
+		u32 all_ones = (1ULL << sbits) - 1;
+		if (m_value.IsImm())
+		{
+			u32 value = (u32)m_value.offset & mask;
+			switch (sbits)
+			{
+			case 8:  m_code->MOV(8, MatR(RSCRATCH2), Imm8((u8)value)); break;
+			case 16: m_code->MOV(16, MatR(RSCRATCH2), Imm16((u16)value)); break;
+			case 32: m_code->MOV(32, MatR(RSCRATCH2), Imm32(value)); break;
+			}
+		}
+		else if ((all_ones & mask) == all_ones && m_value.IsSimpleReg())
+		{
+			m_code->MOV(sbits, MatR(RSCRATCH2), m_value);
+		}
+		else
+		{
+			m_code->MOV(sbits, R(RSCRATCH), m_value);
+			if ((all_ones & mask) != all_ones)
+				m_code->AND(32, R(RSCRATCH), Imm32(mask));
+			m_code->MOV(sbits, MatR(RSCRATCH2), R(RSCRATCH));
+		}
+	}
+
+	void CallLambda(int sbits, const std::function<void(u32, T)>* lambda)
+	{
+		// Helps external systems know which instruction triggered the write
+		m_code->MOV(32, PPCSTATE(pc), Imm32(m_pc));
+
+		m_code->ABI_PushRegistersAndAdjustStack(m_registers_in_use, 0);
+		// The handler takes a T, so make sure the upper bits are clear.
+		Gen::OpArg value = m_value;
+		if (value.IsImm())
+		{
+			value = Imm32((u32)value.offset & (u32)((1ULL << sbits) - 1));
+		}
+		else if (sbits < 32)
+		{
+			m_code->MOVZX(32, sbits, ABI_PARAM3, value);
+			value = R(ABI_PARAM3);
+		}
+		m_code->ABI_CallLambdaCA(lambda, m_address, value);
+		m_code->ABI_PopRegistersAndAdjustStack(m_registers_in_use, 0);
+		m_calls_handler = true;
+	}
+
+	Gen::X64CodeBlock* m_code;
+	BitSet32 m_registers_in_use;
+	Gen::OpArg m_value;
+	u32 m_address;
+	u32 m_pc;
+	bool m_calls_handler;
+};
+
 void EmuCodeBlock::MMIOLoadToReg(MMIO::Mapping* mmio, Gen::X64Reg reg_value,
                                  BitSet32 registers_in_use, u32 address,
                                  int access_size, bool sign_extend)
 {
+	if (mmio->IsCountingAccesses())
+	{
+		MOV(64, R(RSCRATCH), ImmPtr(mmio->GetReadCounter(address)));
+		ADD(64, MatR(RSCRATCH), Imm8(1));
+	}
+
 	switch (access_size)
 	{
 	case 8:
@@ -250,6 +344,42 @@ void EmuCodeBlock::MMIOLoadToReg(MMIO::Mapping* mmio, Gen::X64Reg reg_value,
 	}
 }
 
+bool EmuCodeBlock::MMIOWriteRegToAddr(MMIO::Mapping* mmio, Gen::OpArg value,
+                                      BitSet32 registers_in_use, u32 address,
+                                      int access_size, u32 pc)
+{
+	_assert_msg_(DYNA_REC, !value.IsSimpleReg(RSCRATCH2), "MMIO writes use RSCRATCH2");
+
+	if (mmio->IsCountingAccesses())
+	{
+		MOV(64, R(RSCRATCH2), ImmPtr(mmio->GetWriteCounter(address)));
+		ADD(64, MatR(RSCRATCH2), Imm8(1));
+	}
+
+	switch (access_size)
+	{
+	case 8:
+		{
+			MMIOWriteCodeGenerator<u8> gen(this, registers_in_use, value, address, pc);
+			mmio->GetHandlerForWrite<u8>(address).Visit(gen);
+			return gen.CallsHandler();
+		}
+	case 16:
+		{
+			MMIOWriteCodeGenerator<u16> gen(this, registers_in_use, value, address, pc);
+			mmio->GetHandlerForWrite<u16>(address).Visit(gen);
+			return gen.CallsHandler();
+		}
+	case 32:
+		{
+			MMIOWriteCodeGenerator<u32> gen(this, registers_in_use, value, address, pc);
+			mmio->GetHandlerForWrite<u32>(address).Visit(gen);
+			return gen.CallsHandler();
+		}
+	}
+	return false;
+}
+
 FixupBranch EmuCodeBlock::CheckIfSafeAddress(OpArg reg_value, X64Reg reg_addr, BitSet32 registers_in_use, u32 mem_mask)
 {
 	registers_in_use[reg_addr] = true;
@@ -290,6 +420,39 @@ FixupBranch EmuCodeBlock::CheckIfSafeAddress(OpArg reg_value, X64Reg reg_addr, B
 	}
 }
 
+X64Reg EmuCodeBlock::SoftTLBLookup(X64Reg reg_addr, int accessSize, bool write, BitSet32 registers_in_use, FixupBranch* miss)
+{
+	static_assert(sizeof(Memory::SoftTLBEntry) == 8, "soft TLB entries are indexed with SCALE_8");
+
+	registers_in_use[reg_addr] = true;
+	X64Reg scratch[2];
+	int num_scratch = 0;
+	for (X64Reg reg : {RSCRATCH, RSCRATCH2, RSCRATCH_EXTRA})
+	{
+		if (!registers_in_use[reg] && num_scratch < 2)
+			scratch[num_scratch++] = reg;
+	}
+	if (num_scratch < 2)
+		return INVALID_REG;
+
+	X64Reg entry = scratch[0];
+	X64Reg paddr = scratch[1];
+	MOV(32, R(entry), R(reg_addr));
+	SHR(32, R(entry), Imm8(12));
+	AND(32, R(entry), Imm32(Memory::SOFT_TLB_MASK));
+	MOV(64, R(paddr), ImmPtr(write ? Memory::soft_tlb_write : Memory::soft_tlb_read));
+	LEA(64, entry, MComplex(paddr, entry, SCALE_8, 0));
+	// Check the page of the last byte, so that accesses crossing into the
+	// next page miss and get split up by the slow path.
+	LEA(32, paddr, MDisp(reg_addr, accessSize / 8 - 1));
+	AND(32, R(paddr), Imm32(~0xFFF));
+	CMP(32, R(paddr), MDisp(entry, offsetof(Memory::SoftTLBEntry, tag)));
+	*miss = J_CC(CC_NE, true);
+	MOV(32, R(paddr), R(reg_addr));
+	ADD(32, R(paddr), MDisp(entry, offsetof(Memory::SoftTLBEntry, offset)));
+	return paddr;
+}
+
 void EmuCodeBlock::SafeLoadToReg(X64Reg reg_value, const Gen::OpArg & opAddress, int accessSize, s32 offset, BitSet32 registersInUse, bool signExtend, int flags)
 {
 	if (!jit->js.memcheck)
@@ -299,11 +462,7 @@ void EmuCodeBlock::SafeLoadToReg(X64Reg reg_value, const Gen::OpArg & opAddress,
 	if (!SConfig::GetInstance().m_LocalCoreStartupParameter.bMMU &&
 	    SConfig::GetInstance().m_LocalCoreStartupParameter.bFastmem &&
 	    !opAddress.IsImm() &&
-	    !(flags & (SAFE_LOADSTORE_NO_SWAP | SAFE_LOADSTORE_NO_FASTMEM))
-#ifdef ENABLE_MEM_CHECK
-	    && !SConfig::GetInstance().m_LocalCoreStartupParameter.bEnableDebugging
-#endif
-	    )
+	    !(flags & (SAFE_LOADSTORE_NO_SWAP | SAFE_LOADSTORE_NO_FASTMEM)))
 	{
 		u8 *mov = UnsafeLoadToReg(reg_value, opAddress, accessSize, offset, signExtend);
 
@@ -324,12 +483,13 @@ void EmuCodeBlock::SafeLoadToReg(X64Reg reg_value, const Gen::OpArg & opAddress,
 			// order:
 			//
 			// 1. If the address is in RAM, generate an unsafe load (directly
-			//    access the RAM buffer and load from there).
+			//    access the RAM buffer and load from there). This doesn't go
+			//    through the mirrors memchecks protect, so not while there are any.
 			// 2. If the address is in the MMIO range, find the appropriate
 			//    MMIO handler and generate the code to load using the handler.
 			// 3. Otherwise, just generate a call to Memory::Read_* with the
 			//    address hardcoded.
-			if (Memory::IsRAMAddress(address))
+			if (Memory::IsRAMAddress(address) && !PowerPC::memchecks.HasAny())
 			{
 				UnsafeLoadToReg(reg_value, opAddress, accessSize, offset, signExtend);
 			}
@@ -381,6 +541,24 @@ void EmuCodeBlock::SafeLoadToReg(X64Reg reg_value, const Gen::OpArg & opAddress,
 			else
 				exit = J(true);
 			SetJumpTarget(slow);
+
+			// Under the MMU, most of the accesses that end up here are to
+			// translated addresses that the soft TLB can resolve without a call.
+			FixupBranch tlb_miss, tlb_exit;
+			X64Reg paddr = INVALID_REG;
+			if (SConfig::GetInstance().m_LocalCoreStartupParameter.bMMU)
+			{
+				BitSet32 tlb_registers_in_use = registersInUse;
+				tlb_registers_in_use[reg_value] = true;
+				paddr = SoftTLBLookup(reg_addr, accessSize, false, tlb_registers_in_use, &tlb_miss);
+			}
+			if (paddr != INVALID_REG)
+			{
+				UnsafeLoadToReg(reg_value, R(paddr), accessSize, 0, signExtend);
+				tlb_exit = J(true);
+				SetJumpTarget(tlb_miss);
+			}
+
 			size_t rsp_alignment = (flags & SAFE_LOADSTORE_NO_PROLOG) ? 8 : 0;
 			ABI_PushRegistersAndAdjustStack(registersInUse, rsp_alignment);
 			switch (accessSize)
@@ -418,6 +596,8 @@ void EmuCodeBlock::SafeLoadToReg(X64Reg reg_value, const Gen::OpArg & opAddress,
 				SwitchToNearCode();
 			}
 			SetJumpTarget(exit);
+			if (paddr != INVALID_REG)
+				SetJumpTarget(tlb_exit);
 		}
 	}
 }
@@ -511,11 +691,17 @@ bool EmuCodeBlock::WriteToConstAddress(int accessSize, OpArg arg, u32 address, B
 		UnsafeWriteGatherPipe(accessSize);
 		return false;
 	}
-	else if (Memory::IsRAMAddress(address))
+	else if (Memory::IsRAMAddress(address) && !PowerPC::memchecks.HasAny())
 	{
 		WriteToConstRamAddress(accessSize, arg, address);
 		return false;
 	}
+	else if (!SConfig::GetInstance().m_LocalCoreStartupParameter.bMMU && MMIO::IsMMIOAddress(address) &&
+	         accessSize != 64 && !PowerPC::memchecks.HasAny())
+	{
+		return MMIOWriteRegToAddr(Memory::mmio_mapping, arg, registersInUse, address, accessSize,
+		                          jit->js.compilerPC);
+	}
 	else
 	{
 		// Helps external systems know which instruction triggered the write
@@ -551,11 +737,7 @@ void EmuCodeBlock::SafeWriteRegToReg(OpArg reg_value, X64Reg reg_addr, int acces
 	if (!SConfig::GetInstance().m_LocalCoreStartupParameter.bMMU &&
 	    SConfig::GetInstance().m_LocalCoreStartupParameter.bFastmem &&
 	    !(flags & SAFE_LOADSTORE_NO_FASTMEM) &&
-		(reg_value.IsImm() || !(flags & SAFE_LOADSTORE_NO_SWAP))
-#ifdef ENABLE_MEM_CHECK
-	    && !SConfig::GetInstance().m_LocalCoreStartupParameter.bEnableDebugging
-#endif
-	    )
+		(reg_value.IsImm() || !(flags & SAFE_LOADSTORE_NO_SWAP)))
 	{
 		const u8* backpatchStart = GetCodePtr();
 		u8* mov = UnsafeWriteRegToReg(reg_value, reg_addr, accessSize, offset, !(flags & SAFE_LOADSTORE_NO_SWAP));
@@ -599,6 +781,22 @@ void EmuCodeBlock::SafeWriteRegToReg(OpArg reg_value, X64Reg reg_addr, int acces
 		exit = J(true);
 	SetJumpTarget(slow);
 
+	FixupBranch tlb_miss, tlb_exit;
+	X64Reg paddr = INVALID_REG;
+	if (SConfig::GetInstance().m_LocalCoreStartupParameter.bMMU)
+	{
+		BitSet32 tlb_registers_in_use = registersInUse;
+		if (reg_value.IsSimpleReg())
+			tlb_registers_in_use[reg_value.GetSimpleReg()] = true;
+		paddr = SoftTLBLookup(reg_addr, accessSize, true, tlb_registers_in_use, &tlb_miss);
+	}
+	if (paddr != INVALID_REG)
+	{
+		UnsafeWriteRegToReg(reg_value, paddr, accessSize, 0, swap);
+		tlb_exit = J(true);
+		SetJumpTarget(tlb_miss);
+	}
+
 	// PC is used by memory watchpoints (if enabled) or to print accurate PC locations in debug logs
 	MOV(32, PPCSTATE(pc), Imm32(jit->js.compilerPC));
 
@@ -639,6 +837,8 @@ void EmuCodeBlock::SafeWriteRegToReg(OpArg reg_value, X64Reg reg_addr, int acces
 		SwitchToNearCode();
 	}
 	SetJumpTarget(exit);
+	if (paddr != INVALID_REG)
+		SetJumpTarget(tlb_exit);
 }
 
 void EmuCodeBlock::WriteToConstRamAddress(int accessSize, OpArg arg, u32 address, bool swap)
@@ -969,100 +1169,15 @@ void EmuCodeBlock::ConvertSingleToDouble(X64Reg dst, X64Reg src, bool src_is_gpr
 	MOVDDUP(dst, R(dst));
 }
 
-static const u64 GC_ALIGNED16(psDoubleExp[2])  = {0x7FF0000000000000ULL, 0};
-static const u64 GC_ALIGNED16(psDoubleFrac[2]) = {0x000FFFFFFFFFFFFFULL, 0};
-static const u64 GC_ALIGNED16(psDoubleNoSign[2]) = {0x7FFFFFFFFFFFFFFFULL, 0};
-
-// TODO: it might be faster to handle FPRF in the same way as CR is currently handled for integer, storing
-// the result of each floating point op and calculating it when needed. This is trickier than for integers
-// though, because there's 32 possible FPRF bit combinations but only 9 categories of floating point values,
-// which makes the whole thing rather trickier.
-// Fortunately, PPCAnalyzer can optimize out a large portion of FPRF calculations, so maybe this isn't
-// quite that necessary.
+// FPRF is computed lazily, the same way CR is handled for integers: we store the result of each
+// floating point op and only classify it when something actually reads FPRF. Everything that does
+// (mffs, mcrfs, mtfsf and friends) goes through the interpreter, which calls FlushFPRF() first.
+// Together with PPCAnalyzer optimizing out FPRF updates that get overwritten within the block,
+// this means the vast majority of results are never classified at all.
 void EmuCodeBlock::SetFPRF(Gen::X64Reg xmm)
 {
-	AND(32, PPCSTATE(fpscr), Imm32(~FPRF_MASK));
-
-	FixupBranch continue1, continue2, continue3, continue4;
-	if (cpu_info.bSSE4_1)
-	{
-		MOVQ_xmm(R(RSCRATCH), xmm);
-		SHR(64, R(RSCRATCH), Imm8(63)); // Get the sign bit; almost all the branches need it.
-		PTEST(xmm, M((void*)psDoubleExp));
-		FixupBranch maxExponent = J_CC(CC_C);
-		FixupBranch zeroExponent = J_CC(CC_Z);
-
-		// Nice normalized number: sign ? PPC_FPCLASS_NN : PPC_FPCLASS_PN;
-		LEA(32, RSCRATCH, MScaled(RSCRATCH, MathUtil::PPC_FPCLASS_NN - MathUtil::PPC_FPCLASS_PN, MathUtil::PPC_FPCLASS_PN));
-		continue1 = J();
-
-		SetJumpTarget(maxExponent);
-		PTEST(xmm, M((void*)psDoubleFrac));
-		FixupBranch notNAN = J_CC(CC_Z);
-
-		// Max exponent + mantissa: PPC_FPCLASS_QNAN
-		MOV(32, R(RSCRATCH), Imm32(MathUtil::PPC_FPCLASS_QNAN));
-		continue2 = J();
-
-		// Max exponent + no mantissa: sign ? PPC_FPCLASS_NINF : PPC_FPCLASS_PINF;
-		SetJumpTarget(notNAN);
-		LEA(32, RSCRATCH, MScaled(RSCRATCH, MathUtil::PPC_FPCLASS_NINF - MathUtil::PPC_FPCLASS_PINF, MathUtil::PPC_FPCLASS_NINF));
-		continue3 = J();
-
-		SetJumpTarget(zeroExponent);
-		PTEST(xmm, R(xmm));
-		FixupBranch zero = J_CC(CC_Z);
-
-		// No exponent + mantissa: sign ? PPC_FPCLASS_ND : PPC_FPCLASS_PD;
-		LEA(32, RSCRATCH, MScaled(RSCRATCH, MathUtil::PPC_FPCLASS_ND - MathUtil::PPC_FPCLASS_PD, MathUtil::PPC_FPCLASS_ND));
-		continue4 = J();
-
-		// Zero: sign ? PPC_FPCLASS_NZ : PPC_FPCLASS_PZ;
-		SetJumpTarget(zero);
-		SHL(32, R(RSCRATCH), Imm8(4));
-		ADD(32, R(RSCRATCH), Imm8(MathUtil::PPC_FPCLASS_PZ));
-	}
-	else
-	{
-		MOVQ_xmm(R(RSCRATCH), xmm);
-		TEST(64, R(RSCRATCH), M((void*)psDoubleExp));
-		FixupBranch zeroExponent = J_CC(CC_Z);
-		AND(64, R(RSCRATCH), M((void*)psDoubleNoSign));
-		CMP(64, R(RSCRATCH), M((void*)psDoubleExp));
-		FixupBranch nan = J_CC(CC_G); // This works because if the sign bit is set, RSCRATCH is negative
-		FixupBranch infinity = J_CC(CC_E);
-		MOVQ_xmm(R(RSCRATCH), xmm);
-		SHR(64, R(RSCRATCH), Imm8(63));
-		LEA(32, RSCRATCH, MScaled(RSCRATCH, MathUtil::PPC_FPCLASS_NN - MathUtil::PPC_FPCLASS_PN, MathUtil::PPC_FPCLASS_PN));
-		continue1 = J();
-		SetJumpTarget(nan);
-		MOVQ_xmm(R(RSCRATCH), xmm);
-		SHR(64, R(RSCRATCH), Imm8(63));
-		MOV(32, R(RSCRATCH), Imm32(MathUtil::PPC_FPCLASS_QNAN));
-		continue2 = J();
-		SetJumpTarget(infinity);
-		MOVQ_xmm(R(RSCRATCH), xmm);
-		SHR(64, R(RSCRATCH), Imm8(63));
-		LEA(32, RSCRATCH, MScaled(RSCRATCH, MathUtil::PPC_FPCLASS_NINF - MathUtil::PPC_FPCLASS_PINF, MathUtil::PPC_FPCLASS_NINF));
-		continue3 = J();
-		SetJumpTarget(zeroExponent);
-		TEST(64, R(RSCRATCH), R(RSCRATCH));
-		FixupBranch zero = J_CC(CC_Z);
-		SHR(64, R(RSCRATCH), Imm8(63));
-		LEA(32, RSCRATCH, MScaled(RSCRATCH, MathUtil::PPC_FPCLASS_ND - MathUtil::PPC_FPCLASS_PD, MathUtil::PPC_FPCLASS_ND));
-		continue4 = J();
-		SetJumpTarget(zero);
-		SHR(64, R(RSCRATCH), Imm8(63));
-		SHL(32, R(RSCRATCH), Imm8(4));
-		ADD(32, R(RSCRATCH), Imm8(MathUtil::PPC_FPCLASS_PZ));
-	}
-
-	SetJumpTarget(continue1);
-	SetJumpTarget(continue2);
-	SetJumpTarget(continue3);
-	SetJumpTarget(continue4);
-	SHL(32, R(RSCRATCH), Imm8(FPRF_SHIFT));
-	OR(32, PPCSTATE(fpscr), R(RSCRATCH));
+	MOVSD(PPCSTATE(fprf_value), xmm);
+	MOV(8, PPCSTATE(fprf_pending), Imm8(1));
 }
 
 void EmuCodeBlock::JitGetAndClearCAOV(bool oe)
@@ -91,7 +91,11 @@ public:
 
 	// Generate a load/write from the MMIO handler for a given address. Only
 	// call for known addresses in MMIO range (MMIO::IsMMIOAddress).
+	// Constant and direct handlers are inlined, complex ones are called
+	// directly. Both clobber RSCRATCH; writes also clobber RSCRATCH2 and
+	// return whether they call a handler.
 	void MMIOLoadToReg(MMIO::Mapping* mmio, Gen::X64Reg reg_value, BitSet32 registers_in_use, u32 address, int access_size, bool sign_extend);
+	bool MMIOWriteRegToAddr(MMIO::Mapping* mmio, Gen::OpArg value, BitSet32 registers_in_use, u32 address, int access_size, u32 pc);
 
 	enum SafeLoadStoreFlags
 	{
@@ -101,6 +105,11 @@ public:
 		SAFE_LOADSTORE_CLOBBER_RSCRATCH_INSTEAD_OF_ADDR = 8
 	};
 
+	// Looks reg_addr up in Memory's soft TLB. On a hit it falls through with the
+	// physical address in the returned register, otherwise it jumps to *miss.
+	// Emits nothing and returns INVALID_REG if there are no free scratch registers.
+	Gen::X64Reg SoftTLBLookup(Gen::X64Reg reg_addr, int accessSize, bool write, BitSet32 registers_in_use, Gen::FixupBranch* miss);
+
 	void SafeLoadToReg(Gen::X64Reg reg_value, const Gen::OpArg & opAddress, int accessSize, s32 offset, BitSet32 registersInUse, bool signExtend, int flags = 0);
 	// Clobbers RSCRATCH or reg_addr depending on the relevant flag.  Preserves
 	// reg_value if the load fails and js.memcheck is enabled.
@@ -9,7 +9,7 @@ void JitILBase::psq_st(UGeckoInstruction inst)
 {
 	INSTRUCTION_START
 	JITDISABLE(bJITLoadStorePairedOff);
-	FALLBACK_IF(js.memcheck || inst.W);
+	FALLBACK_IF(js.memcheck || inst.W || PowerPC::memchecks.HasAny());
 
 	IREmitter::InstLoc addr = ibuild.EmitIntConst(inst.SIMM_12);
 	IREmitter::InstLoc val;
@@ -29,7 +29,7 @@ void JitILBase::psq_l(UGeckoInstruction inst)
 {
 	INSTRUCTION_START
 	JITDISABLE(bJITLoadStorePairedOff);
-	FALLBACK_IF(js.memcheck || inst.W);
+	FALLBACK_IF(js.memcheck || inst.W || PowerPC::memchecks.HasAny());
 
 	IREmitter::InstLoc addr = ibuild.EmitIntConst(inst.SIMM_12);
 	IREmitter::InstLoc val;
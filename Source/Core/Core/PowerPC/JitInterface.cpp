@@ -14,6 +14,7 @@
 
 #include "Core/ConfigManager.h"
 #include "Core/HW/Memmap.h"
+#include "Core/PowerPC/CachedInterpreter.h"
 #include "Core/PowerPC/JitInterface.h"
 #include "Core/PowerPC/PPCSymbolDB.h"
 #include "Core/PowerPC/Profiler.h"
@@ -80,6 +81,11 @@ namespace JitInterface
 				break;
 			}
 			#endif
+			case 5:
+			{
+				ptr = new CachedInterpreter();
+				break;
+			}
 			default:
 			{
 				PanicAlert("Unrecognizable cpu_core: %d", core);
@@ -121,6 +127,11 @@ namespace JitInterface
 				break;
 			}
 			#endif
+			case 5:
+			{
+				// Runs the interpreter's handlers; there are no tables to set up.
+				break;
+			}
 			default:
 			{
 				PanicAlert("Unrecognizable cpu_core: %d", core);
@@ -165,7 +176,7 @@ namespace JitInterface
 			PanicAlert("Failed to open %s", filename.c_str());
 			return;
 		}
-		fprintf(f.GetHandle(), "origAddr\tblkName\tcost\ttimeCost\tpercent\ttimePercent\tOvAllinBlkTime(ms)\tblkCodeSize\n");
+		fprintf(f.GetHandle(), "origAddr\tblkName\tcost\ttimeCost\tpercent\ttimePercent\tOvAllinBlkTime(ms)\tblkCodeSize\tspills\treloads\n");
 		for (auto& stat : stats)
 		{
 			const JitBlock *block = jit->GetBlockCache()->GetBlock(stat.blockNum);
@@ -174,10 +185,11 @@ namespace JitInterface
 				std::string name = g_symbolDB.GetDescription(block->originalAddress);
 				double percent = 100.0 * (double)stat.cost / (double)cost_sum;
 				double timePercent = 100.0 * (double)block->ticCounter / (double)timecost_sum;
-				fprintf(f.GetHandle(), "%08x\t%s\t%" PRIu64 "\t%" PRIu64 "\t%.2f\t%.2f\t%.2f\t%i\n",
+				fprintf(f.GetHandle(), "%08x\t%s\t%" PRIu64 "\t%" PRIu64 "\t%.2f\t%.2f\t%.2f\t%i\t%u\t%u\n",
 						block->originalAddress, name.c_str(), stat.cost,
 						block->ticCounter, percent, timePercent,
-						(double)block->ticCounter*1000.0/(double)countsPerSec, block->codeSize);
+						(double)block->ticCounter*1000.0/(double)countsPerSec, block->codeSize,
+						block->spillCount, block->reloadCount);
 			}
 		}
 	}
@@ -10,6 +10,7 @@
 
 #include "Core/ConfigManager.h"
 #include "Core/GeckoCode.h"
+#include "Core/HLE/HLE.h"
 #include "Core/HW/Memmap.h"
 #include "Core/PowerPC/JitInterface.h"
 #include "Core/PowerPC/PPCAnalyst.h"
@@ -35,6 +36,10 @@ static const int CODEBUFFER_SIZE = 32000;
 // 0 does not perform block merging
 static const u32 FUNCTION_FOLLOWING_THRESHOLD = 16;
 
+// Calls to leaf functions the symbol database knows to be at most this many bytes
+// long are always inlined, and don't count towards FUNCTION_FOLLOWING_THRESHOLD.
+static const int LEAF_INLINE_MAX_SIZE = 32 * 4;
+
 CodeBuffer::CodeBuffer(int size)
 {
 	codebuffer = new PPCAnalyst::CodeOp[size];
@@ -411,6 +416,34 @@ static bool isCror(const CodeOp& a)
 	return a.inst.OPCD == 19 && a.inst.SUBOP10 == 449;
 }
 
+static bool isBranchAndLink(const CodeOp& a)
+{
+	return (a.inst.OPCD == 16 || a.inst.OPCD == 18 ||
+	        (a.inst.OPCD == 19 && (a.inst.SUBOP10 == 16 || a.inst.SUBOP10 == 528))) && a.inst.LK;
+}
+
+// Whether anything outside of the block can look at the register file at this
+// instruction: it can leave the block, raise an exception or be hooked by HLE.
+static bool CanObserveRegisters(const CodeOp& a, bool first_fpu_inst)
+{
+	// A branch that was followed just carries on with the block.
+	if ((a.opinfo->flags & FL_ENDBLOCK) && !a.canEndBlock)
+		return first_fpu_inst || HLE::GetFunctionIndex(a.address) != 0;
+
+	switch (a.opinfo->type)
+	{
+	case OPTYPE_INTEGER:
+	case OPTYPE_CR:
+	case OPTYPE_DOUBLEFP:
+	case OPTYPE_SINGLEFP:
+	case OPTYPE_FPU:
+	case OPTYPE_PS:
+		return a.canEndBlock || first_fpu_inst || HLE::GetFunctionIndex(a.address) != 0;
+	default:
+		return true;
+	}
+}
+
 void PPCAnalyzer::ReorderInstructionsCore(u32 instructions, CodeOp* code, bool reverse, ReorderType type)
 {
 	// Bubbling an instruction sometimes reveals another opportunity to bubble an instruction, so do
@@ -474,6 +507,49 @@ void PPCAnalyzer::ReorderInstructions(u32 instructions, CodeOp *code)
 		ReorderInstructionsCore(instructions, code, false, REORDER_CMP);
 }
 
+bool PPCAnalyzer::IsBusyWaitLoop(CodeBlock *block, CodeOp *code, u32 instructions)
+{
+	// A loop that waits for something to show up in memory, like an OSWaitCond() style flag,
+	// the VI retrace count or the DSP mailbox, looks like this:
+	//   * it is the whole block, up to its first branch, which jumps back to the start;
+	//   * it doesn't store to memory or touch any other state outside of the registers;
+	//   * every register it reads is either not written by the loop at all, or was
+	//     written earlier in the same iteration.
+	// Then every iteration does exactly the same thing until memory changes, which only
+	// an event can do.
+	BitSet32 regs_read, regs_written;
+	for (u32 i = 0; i < instructions; i++)
+	{
+		const CodeOp& op = code[i];
+		UGeckoInstruction inst = op.inst;
+
+		if (op.opinfo->flags & FL_ENDBLOCK)
+		{
+			u32 destination;
+			if (inst.OPCD == 18)
+				destination = (inst.AA ? 0 : op.address) + SignExt26(inst.LI << 2);
+			else if (inst.OPCD == 16 && (inst.BO & BO_DONT_DECREMENT_FLAG))
+				destination = (inst.AA ? 0 : op.address) + SignExt16(inst.BD << 2);
+			else
+				return false;
+
+			return !inst.LK && destination == block->m_address;
+		}
+
+		if ((op.opinfo->type != OPTYPE_INTEGER && op.opinfo->type != OPTYPE_LOAD) ||
+		    (op.opinfo->flags & (FL_READ_CA | FL_EVIL | FL_TIMER)))
+		{
+			return false;
+		}
+
+		regs_read |= op.regsIn & ~regs_written;
+		if (op.regsOut & regs_read)
+			return false;
+		regs_written |= op.regsOut;
+	}
+	return false;
+}
+
 void PPCAnalyzer::SetInstructionStats(CodeBlock *block, CodeOp *code, GekkoOPInfo *opinfo, u32 index)
 {
 	code->wantsCR0 = false;
@@ -501,6 +577,20 @@ void PPCAnalyzer::SetInstructionStats(CodeBlock *block, CodeOp *code, GekkoOPInf
 	else
 		code->outputCR1 = (opinfo->flags & FL_SET_CR1) ? true : false;
 
+	// mtcrf only writes the fields selected by CRM; RS happens to occupy the crfD bits.
+	if (code->inst.OPCD == 31 && code->inst.SUBOP10 == 144)
+	{
+		code->outputCR0 = (code->inst.CRM & 0x80) != 0;
+		code->outputCR1 = (code->inst.CRM & 0x40) != 0;
+	}
+
+	// Condition register logic ops read (and, for crbD, merge into) single bits of a field.
+	if (opinfo->type == OPTYPE_CR)
+	{
+		code->wantsCR0 = (code->inst.CRBA >> 2) == 0 || (code->inst.CRBB >> 2) == 0 || (code->inst.CRBD >> 2) == 0;
+		code->wantsCR1 = (code->inst.CRBA >> 2) == 1 || (code->inst.CRBB >> 2) == 1 || (code->inst.CRBD >> 2) == 1;
+	}
+
 	code->wantsFPRF = (opinfo->flags & FL_READ_FPRF) ? true : false;
 	code->outputFPRF = (opinfo->flags & FL_SET_FPRF) ? true : false;
 	code->canEndBlock = (opinfo->flags & FL_ENDBLOCK) ? true : false;
@@ -606,12 +696,6 @@ void PPCAnalyzer::SetInstructionStats(CodeBlock *block, CodeOp *code, GekkoOPInf
 	case OPTYPE_DOUBLEFP:
 		break;
 	case OPTYPE_BRANCH:
-		if (code->inst.hex == 0x4e800020)
-		{
-			// For analysis purposes, we can assume that blr eats opinfo->flags.
-			code->outputCR0 = true;
-			code->outputCR1 = true;
-		}
 		break;
 	case OPTYPE_SYSTEM:
 	case OPTYPE_SYSTEMFP:
@@ -660,6 +744,7 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock *block, CodeBuffer *buffer, u32
 
 	bool found_exit = false;
 	u32 return_address = 0;
+	bool inlining_leaf = false;
 	u32 numFollows = 0;
 	u32 num_inst = 0;
 
@@ -684,6 +769,7 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock *block, CodeBuffer *buffer, u32
 			SetInstructionStats(block, &code[i], opinfo, i);
 
 			bool follow = false;
+			bool free_follow = false;
 			u32 destination = 0;
 
 			bool conditional_continue = false;
@@ -698,8 +784,29 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock *block, CodeBuffer *buffer, u32
 						destination = SignExt26(inst.LI << 2);
 					else
 						destination = address + SignExt26(inst.LI << 2);
-					if (destination != block->m_address)
+					// Code outside of RAM can't be safely followed at compile time.
+					if (destination != block->m_address && Memory::IsRAMAddress(destination))
 						follow = true;
+
+					if (follow && inst.LK)
+					{
+						// If the symbol database knows the callee, only follow it if it comes
+						// straight back. Following a call into anything bigger just drags the
+						// block along into the callee, and a stale symbol is merely a bad guess.
+						const auto& functions = g_symbolDB.Symbols();
+						auto callee = functions.find(destination);
+						if (callee != functions.end() && callee->second.type == Symbol::SYMBOL_FUNCTION)
+						{
+							if ((callee->second.flags & FFLAG_LEAF) && callee->second.size <= LEAF_INLINE_MAX_SIZE)
+								free_follow = inlining_leaf = true;
+							else
+								follow = false;
+						}
+					}
+
+					// A followed bl can have its blr followed back to us.
+					if (follow && inst.LK)
+						return_address = address + 4;
 				}
 				else if (inst.OPCD == 19 && inst.SUBOP10 == 16 &&
 					(inst.BO & (1 << 4)) && (inst.BO & (1 << 2)) &&
@@ -707,6 +814,8 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock *block, CodeBuffer *buffer, u32
 				{
 					// bclrx with unconditional branch = return
 					follow = true;
+					free_follow = inlining_leaf;
+					inlining_leaf = false;
 					destination = return_address;
 					return_address = 0;
 
@@ -722,6 +831,7 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock *block, CodeBuffer *buffer, u32
 						// We give up to follow the return address
 						// because we have to check the register usage.
 						return_address = 0;
+						inlining_leaf = false;
 					}
 				}
 
@@ -731,8 +841,15 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock *block, CodeBuffer *buffer, u32
 				//       cache clearning will happen many times.
 				// TODO: Investivate the reason why
 				//       "0" is fastest in some games, MP2 for example.
-				if (numFollows > FUNCTION_FOLLOWING_THRESHOLD)
+				if (numFollows > FUNCTION_FOLLOWING_THRESHOLD && !free_follow)
 					follow = false;
+
+				// Any other way of setting LR means a later blr can't be followed.
+				if (!follow && opinfo->type == OPTYPE_BRANCH && inst.LK)
+				{
+					return_address = 0;
+					inlining_leaf = false;
+				}
 			}
 
 			if (HasOption(OPTION_CONDITIONAL_CONTINUE))
@@ -773,18 +890,16 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock *block, CodeBuffer *buffer, u32
 					break;
 				}
 			}
-			// XXX: We don't support inlining yet.
-#if 0
 			else
 			{
-				numFollows++;
+				if (!free_follow)
+					numFollows++;
 				// We don't "code[i].skip = true" here
 				// because bx may store a certain value to the link register.
 				// Instead, we skip a part of bx in Jit**::bx().
+				code[i].canEndBlock = false;
 				address = destination;
-				merged_addresses[size_of_merged_addresses++] = address;
 			}
-#endif
 		}
 		else
 		{
@@ -796,6 +911,20 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock *block, CodeBuffer *buffer, u32
 
 	block->m_num_instructions = num_inst;
 
+	// A followed branch that happens to be the last instruction is compiled as a real exit.
+	if (num_inst > 0)
+		code[num_inst - 1].canEndBlock = (code[num_inst - 1].opinfo->flags & FL_ENDBLOCK) != 0;
+
+	// Only the first branch of a block can close a loop that is the whole block.
+	for (u32 i = 0; i < num_inst; i++)
+	{
+		if (code[i].opinfo->flags & FL_ENDBLOCK)
+		{
+			code[i].branchIsIdleLoop = IsBusyWaitLoop(block, code, i + 1);
+			break;
+		}
+	}
+
 	if (block->m_num_instructions > 1)
 		ReorderInstructions(block->m_num_instructions, code);
 
@@ -805,16 +934,30 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock *block, CodeBuffer *buffer, u32
 		block->m_broken = true;
 	}
 
+	// The first FPU instruction gets checked for the FPU being disabled.
+	u32 first_fpu_inst = block->m_num_instructions;
+	for (u32 i = 0; i < block->m_num_instructions; i++)
+	{
+		if (code[i].opinfo->flags & FL_USE_FPU)
+		{
+			first_fpu_inst = i;
+			break;
+		}
+	}
+
 	// Scan for flag dependencies; assume the next block (or any branch that can leave the block)
 	// wants flags, to be safe.
-	bool wantsCR0 = true, wantsCR1 = true, wantsFPRF = true, wantsCA = true;
-	BitSet32 fprInUse, gprInUse, gprInReg, fprInXmm;
+	bool wantsCR0 = true, wantsCR1 = true, wantsFPRF = true, wantsCA = true, wantsLR = true;
+	BitSet32 fprInUse, gprInUse, gprInReg, fprInXmm, gprDiscardable;
 	for (int i = block->m_num_instructions - 1; i >= 0; i--)
 	{
-		bool opWantsCR0 = code[i].wantsCR0;
+		// An exception or HLE hook sees CR and XER as they are in ppcState, so treat anything
+		// that could observe them as a reader.
+		bool observes = CanObserveRegisters(code[i], (u32)i == first_fpu_inst);
+		bool opWantsCR0 = code[i].wantsCR0 || observes;
 		bool opWantsCR1 = code[i].wantsCR1;
 		bool opWantsFPRF = code[i].wantsFPRF;
-		bool opWantsCA = code[i].wantsCA;
+		bool opWantsCA = code[i].wantsCA || observes;
 		code[i].wantsCR0 = wantsCR0 || code[i].canEndBlock;
 		code[i].wantsCR1 = wantsCR1 || code[i].canEndBlock;
 		code[i].wantsFPRF = wantsFPRF || code[i].canEndBlock;
@@ -827,12 +970,20 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock *block, CodeBuffer *buffer, u32
 		wantsCR1 &= !code[i].outputCR1 || opWantsCR1;
 		wantsFPRF &= !code[i].outputFPRF || opWantsFPRF;
 		wantsCA &= !code[i].outputCA || opWantsCA;
+		// Only followed branches can get here without observing LR, and those don't read it.
+		code[i].wantsLR = wantsLR;
+		wantsLR = observes || (wantsLR && !isBranchAndLink(code[i]));
 		code[i].gprInUse = gprInUse;
 		code[i].fprInUse = fprInUse;
 		code[i].gprInReg = gprInReg;
 		code[i].fprInXmm = fprInXmm;
-		// TODO: if there's no possible endblocks or exceptions in between, tell the regcache
-		// we can throw away a register if it's going to be overwritten later.
+		code[i].gprDiscardable = gprDiscardable;
+		// A register can be thrown away if it's going to be overwritten later, as long as
+		// there's no possible endblock or exception in between.
+		if (observes)
+			gprDiscardable = BitSet32(0);
+		else
+			gprDiscardable = (gprDiscardable | code[i].regsOut) & ~code[i].regsIn;
 		gprInUse |= code[i].regsIn;
 		gprInReg |= code[i].regsIn;
 		fprInUse |= code[i].fregsIn;
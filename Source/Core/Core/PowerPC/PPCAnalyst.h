@@ -41,13 +41,21 @@ struct CodeOp //16B
 	bool outputCR1;
 	bool outputFPRF;
 	bool outputCA;
+	// whether the LR written by this instruction can be read before it's overwritten.
+	bool wantsLR;
 	bool canEndBlock;
+	// whether this is the backwards branch of a loop that only waits for memory to change,
+	// so running it again before the next event is pointless.
+	bool branchIsIdleLoop;
 	bool skip;  // followed BL-s for example
 	// which registers are still needed after this instruction in this block
 	BitSet32 fprInUse;
 	BitSet32 gprInUse;
 	// just because a register is in use doesn't mean we actually need or want it in an x86 register.
 	BitSet32 gprInReg;
+	// registers whose value after this instruction is overwritten before anything can read it,
+	// so it never needs to be written back.
+	BitSet32 gprDiscardable;
 	// we do double stores from GPRs, so we don't want to load a PowerPC floating point register into
 	// an XMM only to move it again to a GPR afterwards.
 	BitSet32 fprInXmm;
@@ -170,6 +178,7 @@ private:
 	void ReorderInstructionsCore(u32 instructions, CodeOp* code, bool reverse, ReorderType type);
 	void ReorderInstructions(u32 instructions, CodeOp *code);
 	void SetInstructionStats(CodeBlock *block, CodeOp *code, GekkoOPInfo *opinfo, u32 index);
+	bool IsBusyWaitLoop(CodeBlock *block, CodeOp *code, u32 instructions);
 
 	// Options
 	u32 m_options;
@@ -184,9 +193,10 @@ public:
 		OPTION_CONDITIONAL_CONTINUE = (1 << 0),
 
 		// If there is a unconditional branch that jumps to a leaf function then inline it.
-		// Might require JIT intervention to support it correctly.
-		// Requires JITBLock support for inlined code
-		// XXX: NOT COMPLETE
+		// Unconditional b/bl are followed, and so is a blr that returns to a followed bl.
+		// Calls into functions in the symbol database are only followed if they are small leaves.
+		// Requires JIT support: the followed branches must not end the block, and the
+		// block is no longer contiguous in memory (see JitBlock::physicalRanges).
 		OPTION_LEAF_INLINE = (1 << 1),
 
 		// Complex blocks support jumping backwards on to themselves.
@@ -2,6 +2,8 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <cinttypes>
+
 #include "Common/Atomic.h"
 #include "Common/ChunkFile.h"
 #include "Common/CommonTypes.h"
@@ -34,6 +36,7 @@ static volatile CPUState state = CPU_POWERDOWN;
 
 Interpreter * const interpreter = Interpreter::getInstance();
 static CoreMode mode;
+static std::map<u32, u64> idle_loop_cycles;
 
 Watches watches;
 BreakPoints breakpoints;
@@ -67,7 +70,10 @@ void DoState(PointerWrap &p)
 	// rSPR(SPR_DEC) = SystemTimers::GetFakeDecrementer();
 	// *((u64 *)&TL) = SystemTimers::GetFakeTimeBase(); //works since we are little endian and TL comes first :)
 
+	FlushFPRF();
 	p.DoPOD(ppcState);
+	if (p.GetMode() == PointerWrap::MODE_READ)
+		Memory::FlushSoftTLB();
 
 	// SystemTimers::DecrementerSet();
 	// SystemTimers::TimeBaseSet();
@@ -97,6 +103,7 @@ static void ResetRegisters()
 	ppcState.spr[SPR_ECID_L] = 0x82bb08e8;
 
 	ppcState.fpscr = 0;
+	ppcState.fprf_pending = 0;
 	ppcState.pc = 0;
 	ppcState.npc = 0;
 	ppcState.Exceptions = 0;
@@ -134,6 +141,7 @@ void Init(int cpu_core)
 			}
 		}
 	}
+	Memory::FlushSoftTLB();
 
 	ResetRegisters();
 	PPCTables::InitTables(cpu_core);
@@ -177,6 +185,10 @@ void Init(int cpu_core)
 
 void Shutdown()
 {
+	for (const auto& loop : idle_loop_cycles)
+		INFO_LOG(POWERPC, "Idle loop at %08x skipped %" PRIu64 " cycles", loop.first, loop.second);
+	idle_loop_cycles.clear();
+
 	JitInterface::Shutdown();
 	interpreter->Shutdown();
 	cpu_core_base = nullptr;
@@ -523,6 +535,18 @@ void OnIdleIL()
 	CoreTiming::Idle();
 }
 
+void OnIdleLoop(u32 loop_address)
+{
+	// Idle() drops what is left of the slice.
+	idle_loop_cycles[loop_address] += ppcState.downcount;
+	CoreTiming::Idle();
+}
+
+const std::map<u32, u64>& GetIdleLoopCycles()
+{
+	return idle_loop_cycles;
+}
+
 }  // namespace
 
 
@@ -531,6 +555,13 @@ void OnIdleIL()
 void UpdateFPRF(double dvalue)
 {
 	FPSCR.FPRF = MathUtil::ClassifyDouble(dvalue);
+	PowerPC::ppcState.fprf_pending = 0;
 	//if (FPSCR.FPRF == 0x11)
 	//	PanicAlert("QNAN alert");
 }
+
+void FlushFPRF()
+{
+	if (PowerPC::ppcState.fprf_pending)
+		UpdateFPRF(MathUtil::IntDouble(PowerPC::ppcState.fprf_value).d);
+}
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <map>
 #include <tuple>
 
 #include "Common/BreakPoints.h"
@@ -87,6 +88,11 @@ struct GC_ALIGNED64(PowerPCState)
 	// The Broadway CPU implements bits 16-23 of the XER register... even though it doesn't support lscbx
 	u16 xer_stringctrl;
 
+	// The JIT records the result of the last floating point op here instead of classifying it
+	// right away; while fprf_pending is set, FPSCR.FPRF is out of date. See FlushFPRF().
+	u8 fprf_pending;
+	u64 fprf_value;
+
 #if _M_X86_64
 	// This member exists for the purpose of an assertion in x86 JitBase.cpp
 	// that its offset <= 0x100.  To minimize code size on x86, we want as much
@@ -156,6 +162,10 @@ void ExpandCR(u32 cr);
 
 void OnIdle(u32 _uThreadAddr);
 void OnIdleIL();
+// Called when a busy-wait loop found by PPCAnalyst branches back to its start.
+void OnIdleLoop(u32 loop_address);
+// The cycles skipped in each of those loops, for debugging.
+const std::map<u32, u64>& GetIdleLoopCycles();
 
 void UpdatePerformanceMonitor(u32 cycles, u32 num_load_stores, u32 num_fp_inst);
 
@@ -310,3 +320,6 @@ inline void SetXER_SO(int value)
 }
 
 void UpdateFPRF(double dvalue);
+// Brings FPSCR.FPRF up to date if the JIT deferred it. Anything that reads FPRF, or only
+// modifies part of it, has to call this first.
+void FlushFPRF();
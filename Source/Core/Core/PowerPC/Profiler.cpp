@@ -2,18 +2,160 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <array>
+#include <cinttypes>
+#include <map>
 #include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#include "Common/FileUtil.h"
+#include "Common/StringUtil.h"
 #include "Core/PowerPC/JitInterface.h"
+#include "Core/PowerPC/PPCSymbolDB.h"
 #include "Core/PowerPC/Profiler.h"
 
 namespace Profiler
 {
 
 bool g_ProfileBlocks;
+bool g_ProfileCallStacks;
+
+struct CallStackFrame
+{
+	u32 function;
+	u32 return_address;
+};
+
+// Deeper frames are still counted, so returns stay balanced, but they aren't
+// stored and don't show up in the samples.
+static const u32 MAX_CALL_STACK_DEPTH = 64;
+
+static std::array<CallStackFrame, MAX_CALL_STACK_DEPTH> s_call_stack;
+static u32 s_call_depth;
+static u64 s_slice_start;
+
+// Keyed by the functions on the call stack followed by the PC at the end of
+// the slice. The PC is only resolved to a function when writing the results,
+// since PPCSymbolDB lookups of addresses inside functions are slow.
+static std::map<std::vector<u32>, u64> s_stack_ticks;
 
 void WriteProfileResults(const std::string& filename)
 {
 	JitInterface::WriteProfileResults(filename);
 }
 
+void OnGuestCall(u32 target, u32 return_address)
+{
+	if (s_call_depth < MAX_CALL_STACK_DEPTH)
+	{
+		s_call_stack[s_call_depth].function = target;
+		s_call_stack[s_call_depth].return_address = return_address;
+	}
+	s_call_depth++;
+}
+
+void OnGuestReturn(u32 target)
+{
+	// Match the return against the stored frames rather than just popping one.
+	// Returns we never saw the call for (and the guest OS switching threads)
+	// would leave the stack out of step otherwise.
+	for (u32 i = std::min(s_call_depth, MAX_CALL_STACK_DEPTH); i > 0; i--)
+	{
+		if (s_call_stack[i - 1].return_address == target)
+		{
+			s_call_depth = i - 1;
+			return;
+		}
+	}
+}
+
+void SampleCallStack(u32 pc)
+{
+	u64 now;
+	QueryPerformanceCounter((LARGE_INTEGER*)&now);
+
+	u32 depth = std::min(s_call_depth, MAX_CALL_STACK_DEPTH);
+	std::vector<u32> key(depth + 1);
+	for (u32 i = 0; i < depth; i++)
+		key[i] = s_call_stack[i].function;
+	key[depth] = pc;
+
+	s_stack_ticks[key] += now - s_slice_start;
+}
+
+void ResumeCallStack()
+{
+	QueryPerformanceCounter((LARGE_INTEGER*)&s_slice_start);
+}
+
+void ResetCallStacks()
+{
+	s_call_depth = 0;
+	s_stack_ticks.clear();
+	ResumeCallStack();
+}
+
+static std::string FunctionName(u32 address)
+{
+	Symbol* symbol = g_symbolDB.GetSymbolFromAddr(address);
+	if (!symbol)
+		return StringFromFormat("%08x", address);
+
+	// ';' separates frames in the output.
+	std::string name = symbol->name;
+	std::replace(name.begin(), name.end(), ';', ':');
+	return name;
+}
+
+void WriteCallStacks(const std::string& filename)
+{
+	File::IOFile f(filename, "w");
+	if (!f)
+	{
+		PanicAlert("Failed to open %s", filename.c_str());
+		return;
+	}
+
+	u64 frequency;
+	QueryPerformanceFrequency((LARGE_INTEGER*)&frequency);
+
+	// Samples that end up in the same functions are merged here.
+	std::map<u32, std::string> names;
+	std::map<std::string, u64> stacks;
+	for (const auto& sample : s_stack_ticks)
+	{
+		std::string stack;
+		const std::string* last = nullptr;
+		for (size_t i = 0; i < sample.first.size(); i++)
+		{
+			u32 address = sample.first[i];
+			auto it = names.find(address);
+			if (it == names.end())
+				it = names.emplace(address, FunctionName(address)).first;
+
+			// The PC is usually in the function called last.
+			if (i == sample.first.size() - 1 && last && *last == it->second)
+				break;
+
+			if (last)
+				stack += ';';
+			stack += it->second;
+			last = &it->second;
+		}
+		stacks[stack] += sample.second;
+	}
+
+	for (const auto& stack : stacks)
+	{
+		u64 us = (u64)(stack.second * 1000000.0 / frequency);
+		if (us)
+			fprintf(f.GetHandle(), "%s %" PRIu64 "\n", stack.first.c_str(), us);
+	}
+}
+
 }  // namespace
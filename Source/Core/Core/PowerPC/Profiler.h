@@ -55,6 +55,22 @@ struct BlockStat
 namespace Profiler
 {
 extern bool g_ProfileBlocks;
+extern bool g_ProfileCallStacks;
 
 void WriteProfileResults(const std::string& filename);
+
+// Call stack profiling: the JIT reports guest calls and returns, and the
+// scheduler takes a sample at the end of every time slice, charging the host
+// time spent running guest code in that slice to the current call stack.
+// Only a few calls per guest function call and per slice, so it is fine to
+// leave enabled while playing.
+void OnGuestCall(u32 target, u32 return_address);
+void OnGuestReturn(u32 target);
+void SampleCallStack(u32 pc);
+void ResumeCallStack();
+
+void ResetCallStacks();
+// Writes the samples in the collapsed stack format used by flamegraph.pl:
+// one "caller;callee;... weight" line per distinct stack, weights in microseconds.
+void WriteCallStacks(const std::string& filename);
 }
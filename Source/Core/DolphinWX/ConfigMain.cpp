@@ -62,6 +62,7 @@ struct CPUCore
 };
 const CPUCore CPUCores[] = {
 	{0, wxTRANSLATE("Interpreter (VERY slow)")},
+	{5, wxTRANSLATE("Cached Interpreter (slower)")},
 #ifdef _M_X86_64
 	{1, wxTRANSLATE("JIT Recompiler (recommended)")},
 	{2, wxTRANSLATE("JITIL Recompiler (slower, experimental)")},
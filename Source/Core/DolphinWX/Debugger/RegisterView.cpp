@@ -45,7 +45,7 @@ static u32 GetSpecialRegValue(int reg)
 	case 1: return PowerPC::ppcState.spr[SPR_LR];
 	case 2: return PowerPC::ppcState.spr[SPR_CTR];
 	case 3: return GetCR();
-	case 4: return PowerPC::ppcState.fpscr;
+	case 4: FlushFPRF(); return PowerPC::ppcState.fpscr;
 	case 5: return PowerPC::ppcState.msr;
 	case 6: return PowerPC::ppcState.spr[SPR_SRR0];
 	case 7: return PowerPC::ppcState.spr[SPR_SRR1];
@@ -153,7 +153,7 @@ static void SetSpecialRegValue(int reg, u32 value)
 	case 1: PowerPC::ppcState.spr[SPR_LR] = value; break;
 	case 2: PowerPC::ppcState.spr[SPR_CTR] = value; break;
 	case 3: SetCR(value); break;
-	case 4: PowerPC::ppcState.fpscr = value; break;
+	case 4: FlushFPRF(); PowerPC::ppcState.fpscr = value; break;
 	case 5: PowerPC::ppcState.msr = value; break;
 	case 6: PowerPC::ppcState.spr[SPR_SRR0] = value; break;
 	case 7: PowerPC::ppcState.spr[SPR_SRR1] = value; break;
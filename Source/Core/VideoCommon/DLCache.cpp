@@ -0,0 +1,251 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <unordered_map>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/Hash.h"
+#include "VideoCommon/BPMemory.h"
+#include "VideoCommon/CPMemory.h"
+#include "VideoCommon/DataReader.h"
+#include "VideoCommon/DLCache.h"
+#include "VideoCommon/OpcodeDecoding.h"
+#include "VideoCommon/Statistics.h"
+#include "VideoCommon/VertexLoaderManager.h"
+#include "VideoCommon/VideoCommon.h"
+#include "VideoCommon/VideoConfig.h"
+#include "VideoCommon/XFMemory.h"
+
+namespace DLCache
+{
+
+bool g_recording = false;
+
+// Cleared when the converted vertices of all cached display lists take up more than this.
+static const size_t MAX_VERTEX_BYTES = 64 * 1024 * 1024;
+
+struct Command
+{
+	u8 cmd_byte;
+	u8 sub_cmd;
+	u16 num_vertices;
+	// Where the data after the command's header starts, from the start of the display list.
+	u32 offset;
+	u32 value;
+	// Where the converted vertices of a primitive are in CachedDisplayList::vertices.
+	// vertex_size is 0 if they have to be converted every time.
+	u32 vertex_offset;
+	u32 vertex_size;
+};
+
+struct CachedDisplayList
+{
+	u64 hash;
+	// The vertex format when the display list was recorded, which the converted
+	// vertices and the sizes of the primitives depend on.
+	TVtxDesc vtx_desc;
+	VAT vtx_attr[8];
+	u32 cycles;
+	// False if it contains something the cache can't replay.
+	bool cacheable;
+	std::vector<Command> commands;
+	std::vector<u8> vertices;
+};
+
+static std::unordered_map<u64, CachedDisplayList> s_cache;
+static size_t s_vertex_bytes;
+
+static CachedDisplayList* s_recording_list;
+static u8* s_recording_start;
+
+void Clear()
+{
+	s_cache.clear();
+	s_vertex_bytes = 0;
+}
+
+static bool VertexFormatMatches(const CachedDisplayList& dl)
+{
+	if (dl.vtx_desc.Hex != g_main_cp_state.vtx_desc.Hex)
+		return false;
+	for (int i = 0; i < 8; i++)
+	{
+		const VAT& vat = g_main_cp_state.vtx_attr[i];
+		if (dl.vtx_attr[i].g0.Hex != vat.g0.Hex ||
+		    dl.vtx_attr[i].g1.Hex != vat.g1.Hex ||
+		    dl.vtx_attr[i].g2.Hex != vat.g2.Hex)
+			return false;
+	}
+	return true;
+}
+
+static void Replay(const CachedDisplayList& dl, u8* data, u32 size)
+{
+	for (const Command& command : dl.commands)
+	{
+		switch (command.cmd_byte)
+		{
+		case GX_LOAD_CP_REG:
+			LoadCPReg(command.sub_cmd, command.value);
+			INCSTAT(stats.thisFrame.numCPLoads);
+			break;
+
+		case GX_LOAD_XF_REG:
+			g_video_buffer_read_ptr = data + command.offset;
+			LoadXFReg(((command.value >> 16) & 15) + 1, command.value & 0xFFFF);
+			INCSTAT(stats.thisFrame.numXFLoads);
+			break;
+
+		case GX_LOAD_INDX_A:
+		case GX_LOAD_INDX_B:
+		case GX_LOAD_INDX_C:
+		case GX_LOAD_INDX_D:
+			LoadIndexedXF(command.value, 0xC + (command.cmd_byte - GX_LOAD_INDX_A) / 8);
+			break;
+
+		case GX_CMD_CALL_DL:
+			WARN_LOG(VIDEO, "recursive display list detected");
+			break;
+
+		case GX_LOAD_BP_REG:
+			LoadBPReg(command.value);
+			INCSTAT(stats.thisFrame.numBPLoads);
+			break;
+
+		default:
+			{
+				int vtx_attr_group = command.cmd_byte & GX_VAT_MASK;
+				int primitive = (command.cmd_byte & GX_PRIMITIVE_MASK) >> GX_PRIMITIVE_SHIFT;
+				if (command.vertex_size &&
+				    VertexLoaderManager::ReplayVertices(vtx_attr_group, primitive, command.num_vertices,
+				                                        &dl.vertices[command.vertex_offset], command.vertex_size,
+				                                        g_bSkipCurrentFrame))
+					break;
+
+				g_video_buffer_read_ptr = data + command.offset;
+				VertexLoaderManager::RunVertices(vtx_attr_group, primitive, command.num_vertices,
+				                                 size - command.offset, g_bSkipCurrentFrame);
+			}
+			break;
+		}
+	}
+}
+
+bool Run(u8* data, u32 address, u32 size, u32* cycles)
+{
+	// The FIFO recorder needs to see every command.
+	if (!g_ActiveConfig.bDListCache || g_bRecordFifoData)
+		return false;
+
+	u64 key = ((u64)address << 32) | size;
+	u64 hash = GetHash64(data, size, 0);
+
+	auto iter = s_cache.find(key);
+	if (iter != s_cache.end() && iter->second.hash == hash)
+	{
+		const CachedDisplayList& dl = iter->second;
+		if (!dl.cacheable)
+			return false;
+
+		if (VertexFormatMatches(dl))
+		{
+			Replay(dl, data, size);
+			INCSTAT(stats.thisFrame.numDListCacheHits);
+			*cycles = dl.cycles;
+			return true;
+		}
+	}
+
+	if (s_vertex_bytes > MAX_VERTEX_BYTES)
+	{
+		Clear();
+		iter = s_cache.end();
+	}
+
+	CachedDisplayList& dl = iter != s_cache.end() ? iter->second : s_cache[key];
+	s_vertex_bytes -= dl.vertices.size();
+	dl.hash = hash;
+	dl.vtx_desc = g_main_cp_state.vtx_desc;
+	for (int i = 0; i < 8; i++)
+		dl.vtx_attr[i] = g_main_cp_state.vtx_attr[i];
+	dl.cacheable = true;
+	dl.commands.clear();
+	dl.vertices.clear();
+
+	s_recording_list = &dl;
+	s_recording_start = data;
+	g_recording = true;
+	dl.cycles = OpcodeDecoder_Run(data + size, true);
+	g_recording = false;
+	s_recording_list = nullptr;
+
+	s_vertex_bytes += dl.vertices.size();
+	INCSTAT(stats.thisFrame.numDListCacheMisses);
+	*cycles = dl.cycles;
+	return true;
+}
+
+void RecordCommand(u8* opcode)
+{
+	CachedDisplayList& dl = *s_recording_list;
+	if (!dl.cacheable)
+		return;
+
+	u8* ptr = opcode;
+	Command command = {};
+	command.cmd_byte = DataRead<u8>(&ptr);
+	switch (command.cmd_byte)
+	{
+	case GX_NOP:
+	case GX_CMD_UNKNOWN_METRICS:
+	case GX_CMD_INVL_VC:
+		return;
+
+	case GX_LOAD_CP_REG:
+		command.sub_cmd = DataRead<u8>(&ptr);
+		command.value = DataRead<u32>(&ptr);
+		break;
+
+	case GX_LOAD_XF_REG:
+	case GX_LOAD_INDX_A:
+	case GX_LOAD_INDX_B:
+	case GX_LOAD_INDX_C:
+	case GX_LOAD_INDX_D:
+	case GX_LOAD_BP_REG:
+		command.value = DataRead<u32>(&ptr);
+		break;
+
+	case GX_CMD_CALL_DL:
+		break;
+
+	default:
+		if ((command.cmd_byte & 0xC0) == 0x80)
+		{
+			command.num_vertices = DataRead<u16>(&ptr);
+
+			u32 vertex_size;
+			const u8* vertices = VertexLoaderManager::GetReplayableVertices(&vertex_size);
+			if (vertex_size)
+			{
+				command.vertex_offset = (u32)dl.vertices.size();
+				command.vertex_size = vertex_size;
+				dl.vertices.insert(dl.vertices.end(), vertices, vertices + vertex_size);
+			}
+		}
+		else
+		{
+			dl.cacheable = false;
+			dl.commands.clear();
+			dl.vertices.clear();
+			return;
+		}
+		break;
+	}
+
+	command.offset = (u32)(ptr - s_recording_start);
+	dl.commands.push_back(command);
+}
+
+}
@@ -0,0 +1,26 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "Common/CommonTypes.h"
+
+// Games tend to call the same static display lists many times per frame. The cache
+// remembers the commands a display list contains and the vertices it converted for
+// them, so that calling it again doesn't have to parse it or convert them again.
+// Entries are checked against a hash of the display list on every call.
+namespace DLCache
+{
+	// True while OpcodeDecoder_Run is decoding a display list for the cache.
+	extern bool g_recording;
+
+	void Clear();
+
+	// Runs the display list at address, whose data is at data, from the cache.
+	// Returns false if it has to be decoded normally instead.
+	bool Run(u8* data, u32 address, u32 size, u32* cycles);
+
+	// Called by the decoder after each command of a display list that is being recorded.
+	void RecordCommand(u8* opcode);
+}
@@ -22,6 +22,7 @@
 #include "VideoCommon/CommandProcessor.h"
 #include "VideoCommon/CPMemory.h"
 #include "VideoCommon/DataReader.h"
+#include "VideoCommon/DLCache.h"
 #include "VideoCommon/Fifo.h"
 #include "VideoCommon/OpcodeDecoding.h"
 #include "VideoCommon/PixelEngine.h"
@@ -54,8 +55,11 @@ static u32 InterpretDisplayList(u32 address, u32 size)
 		// temporarily swap dl and non-dl (small "hack" for the stats)
 		Statistics::SwapDL();
 
-		u8 *end = g_video_buffer_read_ptr + size;
-		cycles = OpcodeDecoder_Run(end, true);
+		if (!DLCache::Run(startAddress, address, size, &cycles))
+		{
+			u8 *end = g_video_buffer_read_ptr + size;
+			cycles = OpcodeDecoder_Run(end, true);
+		}
 		INCSTAT(stats.thisFrame.numDListsCalled);
 
 		// un-swap
@@ -300,6 +304,9 @@ static u32 Decode(u8* end, bool in_display_list)
 	if (!is_preprocess && g_bRecordFifoData && cmd_byte != GX_CMD_CALL_DL)
 		FifoRecorder::GetInstance().WriteGPCommand(opcodeStart, u32(*bufp - opcodeStart));
 
+	if (!is_preprocess && in_display_list && DLCache::g_recording)
+		DLCache::RecordCommand(opcodeStart);
+
 	// In is_preprocess mode, we don't actually care about cycles, at least for
 	// now... make sure the compiler realizes that.
 	return is_preprocess ? 1 : cycles;
@@ -313,6 +320,7 @@ void OpcodeDecoder_Init()
 
 void OpcodeDecoder_Shutdown()
 {
+	DLCache::Clear();
 }
 
 u32 OpcodeDecoder_Run(u8* end, bool in_display_list)
@@ -35,6 +35,8 @@ std::string Statistics::ToString()
 	str += StringFromFormat("vshaders alive: %i\n", stats.numVertexShadersAlive);
 	str += StringFromFormat("shaders changes: %i\n", stats.thisFrame.numShaderChanges);
 	str += StringFromFormat("dlists called: %i\n", stats.thisFrame.numDListsCalled);
+	str += StringFromFormat("dlist cache hits: %i\n", stats.thisFrame.numDListCacheHits);
+	str += StringFromFormat("dlist cache misses: %i\n", stats.thisFrame.numDListCacheMisses);
 	str += StringFromFormat("Primitive joins: %i\n", stats.thisFrame.numPrimitiveJoins);
 	str += StringFromFormat("Draw calls: %i\n", stats.thisFrame.numDrawCalls);
 	str += StringFromFormat("Primitives: %i\n", stats.thisFrame.numPrims);
@@ -49,6 +49,8 @@ struct Statistics
 		int numDrawCalls;
 
 		int numDListsCalled;
+		int numDListCacheHits;
+		int numDListCacheMisses;
 
 		int bytesVertexStreamed;
 		int bytesIndexStreamed;
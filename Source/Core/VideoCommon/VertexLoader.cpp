@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include "Common/CommonTypes.h"
+#include "Common/JitRegister.h"
 #include "Common/MemoryUtil.h"
 #include "Common/StringUtil.h"
 #include "Common/x64ABI.h"
@@ -410,6 +411,13 @@ void VertexLoader::CompileVertexTranslator()
 	J_CC(CC_NZ, loop_start);
 	ABI_PopRegistersAndAdjustStack({RBX}, 8);
 	RET();
+
+	if (JitRegister::IsEnabled())
+	{
+		std::string name;
+		AppendToString(&name);
+		JitRegister::Register(m_compiledCode, GetCodePtr(), ("VertexLoader_" + name).c_str());
+	}
 #endif
 }
 
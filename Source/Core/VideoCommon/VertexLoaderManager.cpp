@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <cstring>
 #include <memory>
 #include <mutex>
 #include <unordered_map>
@@ -12,6 +13,7 @@
 #include "Common/CommonFuncs.h"
 #include "Core/HW/Memmap.h"
 
+#include "VideoCommon/BoundingBox.h"
 #include "VideoCommon/BPMemory.h"
 #include "VideoCommon/IndexGenerator.h"
 #include "VideoCommon/Statistics.h"
@@ -20,9 +22,14 @@
 #include "VideoCommon/VertexManagerBase.h"
 #include "VideoCommon/VertexShaderManager.h"
 #include "VideoCommon/VideoCommon.h"
+#include "VideoCommon/VideoConfig.h"
 
 static NativeVertexFormat* s_current_vtx_fmt;
 
+// The vertices converted by the last RunVertices call, if they can be replayed.
+static const u8* s_last_converted;
+static u32 s_last_converted_size;
+
 namespace std
 {
 
@@ -130,8 +137,41 @@ static VertexLoader* RefreshLoader(int vtx_attr_group, CPState* state)
 	return loader;
 }
 
+// Converted vertices only depend on the vertex data and the vertex format, unless
+// attributes are read from arrays in RAM, or the vertex loader updates the
+// emulated bounding box while converting them.
+static bool CanReplayVertices(const CPState* state)
+{
+	const u64 INDEXED_ATTRIBUTES = 0xAAAAAAULL << 9;
+	return !(state->vtx_desc.Hex & INDEXED_ATTRIBUTES) &&
+	       (g_ActiveConfig.backend_info.bSupportsBBox || !BoundingBox::active);
+}
+
+// Sets up the vertex manager for count more vertices of the given loader's format.
+// Returns false if they don't need to be drawn.
+static bool PrepareVertices(VertexLoader* loader, int primitive, int count, bool skip_drawing)
+{
+	if (skip_drawing || (bpmem.genMode.cullmode == GenMode::CULL_ALL && primitive < 5))
+	{
+		// if cull mode is CULL_ALL, ignore triangles and quads
+		return false;
+	}
+
+	NativeVertexFormat* native = loader->GetNativeVertexFormat();
+
+	// If the native vertex format changed, force a flush.
+	if (native != s_current_vtx_fmt)
+		VertexManager::Flush();
+	s_current_vtx_fmt = native;
+
+	VertexManager::PrepareForAdditionalData(primitive, count,
+			loader->GetNativeVertexDeclaration().stride);
+	return true;
+}
+
 bool RunVertices(int vtx_attr_group, int primitive, int count, size_t buf_size, bool skip_drawing)
 {
+	s_last_converted_size = 0;
 	if (!count)
 		return true;
 
@@ -143,24 +183,45 @@ bool RunVertices(int vtx_attr_group, int primitive, int count, size_t buf_size,
 	if (buf_size < size)
 		return false;
 
-	if (skip_drawing || (bpmem.genMode.cullmode == GenMode::CULL_ALL && primitive < 5))
+	if (!PrepareVertices(loader, primitive, count, skip_drawing))
 	{
-		// if cull mode is CULL_ALL, ignore triangles and quads
 		DataSkip((u32)size);
 		return true;
 	}
 
-	NativeVertexFormat* native = loader->GetNativeVertexFormat();
+	u8* converted = VertexManager::s_pCurBufferPointer;
+	loader->RunVertices(state->vtx_attr[vtx_attr_group], primitive, count);
+	if (CanReplayVertices(state))
+	{
+		s_last_converted = converted;
+		s_last_converted_size = (u32)(VertexManager::s_pCurBufferPointer - converted);
+	}
 
-	// If the native vertex format changed, force a flush.
-	if (native != s_current_vtx_fmt)
-		VertexManager::Flush();
-	s_current_vtx_fmt = native;
+	IndexGenerator::AddIndices(primitive, count);
 
-	VertexManager::PrepareForAdditionalData(primitive, count,
-			loader->GetNativeVertexDeclaration().stride);
+	ADDSTAT(stats.thisFrame.numPrims, count);
+	INCSTAT(stats.thisFrame.numPrimitiveJoins);
+	return true;
+}
 
-	loader->RunVertices(state->vtx_attr[vtx_attr_group], primitive, count);
+const u8* GetReplayableVertices(u32* size)
+{
+	*size = s_last_converted_size;
+	return s_last_converted;
+}
+
+bool ReplayVertices(int vtx_attr_group, int primitive, int count, const u8* vertices, u32 size, bool skip_drawing)
+{
+	CPState* state = &g_main_cp_state;
+	if (!CanReplayVertices(state))
+		return false;
+
+	VertexLoader* loader = RefreshLoader(vtx_attr_group, state);
+	if (!PrepareVertices(loader, primitive, count, skip_drawing))
+		return true;
+
+	memcpy(VertexManager::s_pCurBufferPointer, vertices, size);
+	VertexManager::s_pCurBufferPointer += size;
 
 	IndexGenerator::AddIndices(primitive, count);
 
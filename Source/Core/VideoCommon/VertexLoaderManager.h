@@ -20,6 +20,14 @@ namespace VertexLoaderManager
 	// Returns false if buf_size is insufficient.
 	bool RunVertices(int vtx_attr_group, int primitive, int count, size_t buf_size, bool skip_drawing = false);
 
+	// For the display list cache. Returns the vertices the last RunVertices call
+	// converted, or sets size to 0 if converting them again could give different
+	// results (because they use indexed attributes, for example).
+	const u8* GetReplayableVertices(u32* size);
+	// Adds vertices that RunVertices converted for the current vertex format
+	// before, without converting them again. Returns false if it can't.
+	bool ReplayVertices(int vtx_attr_group, int primitive, int count, const u8* vertices, u32 size, bool skip_drawing = false);
+
 	// For debugging
 	void AppendListToString(std::string *dest);
 
@@ -0,0 +1,48 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <cinttypes>
+#include <cstdlib>
+#include <gtest/gtest.h>
+#include <string>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+#include "Common/FileUtil.h"
+#include "Common/JitRegister.h"
+#include "Common/StringUtil.h"
+
+TEST(JitRegister, DisabledByDefault)
+{
+	JitRegister::Init("");
+	EXPECT_FALSE(JitRegister::IsEnabled());
+	// Must be harmless when nothing is listening.
+	JitRegister::Register("\xC3", 1, "JIT_Test");
+	JitRegister::Shutdown();
+}
+
+#ifndef _WIN32
+TEST(JitRegister, PerfMap)
+{
+	char dir[] = "/tmp/dolphin-jitregister-XXXXXX";
+	ASSERT_NE(nullptr, mkdtemp(dir));
+
+	static const u8 code[] = { 0x90, 0x90, 0xC3 };
+	JitRegister::Init(dir);
+	EXPECT_TRUE(JitRegister::IsEnabled());
+	JitRegister::Register(code, sizeof(code), "JIT_PPC_%08x", 0x80003100);
+	JitRegister::Register(code, code, "JIT_Empty");
+	JitRegister::Shutdown();
+	EXPECT_FALSE(JitRegister::IsEnabled());
+
+	std::string map_path = StringFromFormat("%s/perf-%d.map", dir, getpid());
+	std::string contents;
+	ASSERT_TRUE(File::ReadFileToString(map_path, contents));
+	EXPECT_EQ(StringFromFormat("%" PRIx64 " 3 JIT_PPC_80003100\n", (u64)(uintptr_t)code), contents);
+
+	File::DeleteDirRecursively(dir);
+}
+#endif
@@ -0,0 +1,80 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/MPSCQueue.h"
+
+TEST(MPSCQueue, Simple)
+{
+	Common::MPSCQueue<u32> q;
+
+	EXPECT_TRUE(q.Empty());
+	u32 v;
+	EXPECT_FALSE(q.Pop(v));
+
+	q.Push(1);
+	EXPECT_FALSE(q.Empty());
+	EXPECT_TRUE(q.Pop(v));
+	EXPECT_EQ(1u, v);
+	EXPECT_TRUE(q.Empty());
+
+	// Test the FIFO order, also when pushing while some are already taken by the reader.
+	for (u32 i = 0; i < 1000; ++i)
+		q.Push(i);
+	for (u32 i = 0; i < 500; ++i)
+	{
+		EXPECT_TRUE(q.Pop(v));
+		EXPECT_EQ(i, v);
+	}
+	for (u32 i = 1000; i < 2000; ++i)
+		q.Push(i);
+	for (u32 i = 500; i < 2000; ++i)
+	{
+		EXPECT_TRUE(q.Pop(v));
+		EXPECT_EQ(i, v);
+	}
+	EXPECT_TRUE(q.Empty());
+
+	for (u32 i = 0; i < 1000; ++i)
+		q.Push(i);
+	EXPECT_TRUE(q.Pop(v));
+	EXPECT_FALSE(q.Empty());
+	q.Clear();
+	EXPECT_TRUE(q.Empty());
+}
+
+TEST(MPSCQueue, MultiThreaded)
+{
+	const u32 THREADS = 4;
+	const u32 COUNT = 100000;
+	Common::MPSCQueue<u32> q;
+
+	std::vector<std::thread> inserters;
+	for (u32 t = 0; t < THREADS; ++t)
+	{
+		inserters.emplace_back([&q, t, COUNT] {
+			for (u32 i = 0; i < COUNT; ++i)
+				q.Push((t << 24) | i);
+		});
+	}
+
+	// Each writer's elements come out in order.
+	u32 next[THREADS] = {};
+	for (u32 popped = 0; popped < THREADS * COUNT; ++popped)
+	{
+		u32 v;
+		while (!q.Pop(v));
+		u32 t = v >> 24;
+		ASSERT_LT(t, THREADS);
+		EXPECT_EQ(next[t]++, v & 0xFFFFFF);
+	}
+	EXPECT_TRUE(q.Empty());
+
+	for (auto& inserter : inserters)
+		inserter.join();
+}
@@ -991,4 +991,75 @@ FMA_TEST(VFNMSUB, S, false)
 FMA_TEST(VFMADDSUB, P, true)
 FMA_TEST(VFMSUBADD, P, true)
 
+AVX_RRM_TEST(VADDSD, "qword")
+AVX_RRM_TEST(VSUBSD, "qword")
+AVX_RRM_TEST(VMULSD, "qword")
+AVX_RRM_TEST(VDIVSD, "qword")
+AVX_RRM_TEST(VSQRTSD, "qword")
+AVX_RRM_TEST(VADDPD, "dqword")
+AVX_RRM_TEST(VSUBPD, "dqword")
+AVX_RRM_TEST(VMULPD, "dqword")
+AVX_RRM_TEST(VDIVPD, "dqword")
+AVX_RRM_TEST(VPAND, "dqword")
+AVX_RRM_TEST(VPANDN, "dqword")
+AVX_RRM_TEST(VPOR, "dqword")
+AVX_RRM_TEST(VPXOR, "dqword")
+AVX_RRM_TEST(VANDPD, "dqword")
+AVX_RRM_TEST(VANDNPD, "dqword")
+AVX_RRM_TEST(VORPD, "dqword")
+AVX_RRM_TEST(VXORPD, "dqword")
+AVX_RRM_TEST(VUNPCKLPD, "dqword")
+AVX_RRM_TEST(VUNPCKHPD, "dqword")
+
+// for AVX instructions that take the form op reg, reg, r/m, imm
+#define AVX_RRMI_TEST(Name, sizename) \
+	TEST_F(x64EmitterTest, Name) \
+	{ \
+		for (const auto& r : xmmnames) \
+		{ \
+			emitter->Name(r.reg, RAX, R(RAX), 4); \
+			emitter->Name(RAX, RAX, R(r.reg), 4); \
+			emitter->Name(RAX, r.reg, MatR(R12), 4); \
+			ExpectDisassembly(#Name " " + r.name + ", xmm0, xmm0, 0x04 " \
+			                  #Name " xmm0, xmm0, " + r.name + ", 0x04 " \
+			                  #Name " xmm0, " + r.name + ", " sizename " ptr ds:[r12], 0x04"); \
+		} \
+	}
+
+AVX_RRMI_TEST(VSHUFPD, "dqword")
+AVX_RRMI_TEST(VCMPSD, "qword")
+AVX_RRMI_TEST(VCMPPD, "dqword")
+
+// for AVX instructions that take the form op reg, reg, r/m, reg
+#define AVX_RRMR_TEST(Name) \
+	TEST_F(x64EmitterTest, Name) \
+	{ \
+		for (const auto& r : xmmnames) \
+		{ \
+			emitter->Name(r.reg, RAX, R(RAX), RAX); \
+			emitter->Name(RAX, r.reg, R(RAX), RAX); \
+			emitter->Name(RAX, RAX, MatR(R12), r.reg); \
+			ExpectDisassembly(#Name " " + r.name + ", xmm0, xmm0, xmm0 " \
+			                  #Name " xmm0, " + r.name + ", xmm0, xmm0 " \
+			                  #Name " xmm0, xmm0, dqword ptr ds:[r12], " + r.name); \
+		} \
+	}
+
+AVX_RRMR_TEST(VPBLENDVB)
+AVX_RRMR_TEST(VBLENDVPS)
+AVX_RRMR_TEST(VBLENDVPD)
+
+TEST_F(x64EmitterTest, VMOVDDUP)
+{
+	for (const auto& r : xmmnames)
+	{
+		emitter->VMOVDDUP(r.reg, R(RAX));
+		emitter->VMOVDDUP(RAX, MatR(R12));
+		emitter->VMOVDDUP(r.reg, MatR(R12));
+		ExpectDisassembly("vmovddup " + r.name + ", xmm0 "
+		                  "vmovddup xmm0, qword ptr ds:[r12] "
+		                  "vmovddup " + r.name + ", qword ptr ds:[r12]");
+	}
+}
+
 }  // namespace Gen
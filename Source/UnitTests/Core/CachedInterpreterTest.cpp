@@ -0,0 +1,291 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "Common/BreakPoints.h"
+#include "Common/CommonTypes.h"
+#include "Common/MathUtil.h"
+#include "Core/ConfigManager.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PowerPC/CachedInterpreter.h"
+#include "Core/PowerPC/JitInterface.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "Core/PowerPC/PPCTables.h"
+#include "Core/PowerPC/Interpreter/Interpreter.h"
+
+// include order is important
+#include <gtest/gtest.h>
+
+// Instruction encodings for the guest code below.
+static u32 DForm(u32 opcd, u32 d, u32 a, s32 imm) { return (opcd << 26) | (d << 21) | (a << 16) | (imm & 0xffff); }
+static u32 XForm(u32 opcd, u32 d, u32 a, u32 b, u32 xo) { return (opcd << 26) | (d << 21) | (a << 16) | (b << 11) | (xo << 1); }
+static u32 li(u32 d, s32 imm) { return DForm(14, d, 0, imm); }
+static u32 addi(u32 d, u32 a, s32 imm) { return DForm(14, d, a, imm); }
+static u32 lis(u32 d, s32 imm) { return DForm(15, d, 0, imm); }
+static u32 lwzu(u32 d, u32 a, s32 imm) { return DForm(33, d, a, imm); }
+static u32 stwu(u32 s, u32 a, s32 imm) { return DForm(37, s, a, imm); }
+static u32 lfd(u32 d, u32 a, s32 imm) { return DForm(50, d, a, imm); }
+static u32 stfd(u32 s, u32 a, s32 imm) { return DForm(54, s, a, imm); }
+static u32 add(u32 d, u32 a, u32 b) { return XForm(31, d, a, b, 266); }
+static u32 mullw(u32 d, u32 a, u32 b) { return XForm(31, d, a, b, 235); }
+static u32 xor_(u32 a, u32 s, u32 b) { return XForm(31, s, a, b, 316); }
+static u32 mr(u32 a, u32 s) { return XForm(31, s, a, s, 444); }
+static u32 rotlwi(u32 a, u32 s, u32 n) { return (21u << 26) | (s << 21) | (a << 16) | (n << 11) | (31 << 1); }
+static u32 mtctr(u32 s) { return 0x7C0903A6 | (s << 21); }
+static u32 fadd(u32 d, u32 a, u32 b) { return XForm(63, d, a, b, 21); }
+static u32 fmul(u32 d, u32 a, u32 c) { return (63u << 26) | (d << 21) | (a << 16) | (c << 6) | (25 << 1); }
+static u32 fcmpu(u32 crf, u32 a, u32 b) { return XForm(63, crf << 2, a, b, 0); }
+static u32 cror(u32 d, u32 a, u32 b) { return XForm(19, d, a, b, 449); }
+static u32 bdnz(s32 offset) { return DForm(16, 16, 0, offset); }
+static u32 beq(s32 offset) { return DForm(16, 12, 2, offset); }
+static u32 bl(s32 offset) { return (18u << 26) | (offset & 0x3fffffc) | 1; }
+static u32 b(s32 offset) { return (18u << 26) | (offset & 0x3fffffc); }
+static const u32 blr = 0x4E800020;
+
+// A small stand-in for what a game does when it boots: clear its BSS, copy its data
+// section into place, checksum it in a function call, and do a bit of floating point.
+class CachedInterpreterTest : public testing::Test
+{
+protected:
+	enum : u32
+	{
+		START = 0x80003100,
+		BSS = 0x80100000,
+		DATA = 0x80200000,
+		BSS_WORDS = 0x1000,
+		COPY_WORDS = 0x800,
+	};
+
+	static void SetUpTestCase()
+	{
+		// Never shut down, since that would save the settings to the user directory.
+		SConfig::Init();
+	}
+
+	void SetUp() override
+	{
+		SConfig::GetInstance().m_LocalCoreStartupParameter.bMMU = false;
+		SConfig::GetInstance().m_LocalCoreStartupParameter.bEnableDebugging = false;
+		PPCTables::InitTables(SCoreStartupParameter::CORE_CACHEDINTERPRETER);
+
+		// Memory::Init() needs a video backend for the MMIO handlers, and
+		// nothing here touches MMIO, so just provide a GameCube's worth of RAM.
+		m_ram.reset(new u8[Memory::RAM_SIZE]());
+		Memory::m_pRAM = m_ram.get();
+		Memory::base = m_ram.get();
+		Memory::m_pEXRAM = nullptr;
+		Memory::bFakeVMEM = false;
+
+		m_program = {
+			lis(3, BSS >> 16),           // clear the BSS
+			li(4, 0),
+			li(5, BSS_WORDS),
+			mtctr(5),
+			addi(3, 3, -4),
+			stwu(4, 3, 4),               // 5: clear loop
+			bdnz(-4),
+			lis(6, DATA >> 16),          // copy the data section over it
+			addi(6, 6, -4),
+			lis(7, BSS >> 16),
+			addi(7, 7, -4),
+			li(5, COPY_WORDS),
+			mtctr(5),
+			lwzu(8, 6, 4),               // 13: copy loop
+			stwu(8, 7, 4),
+			bdnz(-8),
+			lis(3, BSS >> 16),           // checksum it
+			li(4, COPY_WORDS),
+			bl(13 * 4),
+			mr(20, 3),
+			lis(9, DATA >> 16),          // 20: some floating point
+			lfd(1, 9, 0),
+			lfd(2, 9, 8),
+			fadd(3, 1, 2),
+			fmul(4, 3, 1),
+			fcmpu(1, 4, 3),
+			stfd(4, 9, 16),
+			cror(2, 5, 6),
+			beq(8),
+			li(21, 1),
+			b(0),                        // 30: END
+			mtctr(4),                    // 31: the checksum function
+			addi(3, 3, -4),
+			li(10, 0),
+			lwzu(11, 3, 4),              // 34: checksum loop
+			rotlwi(10, 10, 5),
+			xor_(10, 10, 11),
+			mullw(12, 11, 11),
+			add(10, 10, 12),
+			bdnz(-20),
+			mr(3, 10),
+			blr,
+		};
+
+		m_cached.reset(new CachedInterpreter());
+		jit = m_cached.get();
+		m_cached->Init();
+	}
+
+	void TearDown() override
+	{
+		PowerPC::breakpoints.Clear();
+		m_cached->Shutdown();
+		jit = nullptr;
+		Memory::m_pRAM = nullptr;
+		Memory::base = nullptr;
+	}
+
+	static u32 Address(u32 index) { return START + index * 4; }
+
+	void LoadGuest()
+	{
+		for (u32 i = 0; i < m_program.size(); i++)
+			Memory::Write_U32(m_program[i], Address(i));
+		for (u32 i = 0; i < BSS_WORDS; i++)
+			Memory::Write_U32(0xDEADBEEF, BSS + i * 4);
+		for (u32 i = 0; i < COPY_WORDS; i++)
+			Memory::Write_U32(i * 0x9E3779B1, DATA + i * 4);
+		Memory::Write_U64(MathUtil::IntDouble(1.5).i, DATA);
+		Memory::Write_U64(MathUtil::IntDouble(2.25).i, DATA + 8);
+
+		memset(PowerPC::ppcState.gpr, 0, sizeof(PowerPC::ppcState.gpr));
+		memset(PowerPC::ppcState.ps, 0, sizeof(PowerPC::ppcState.ps));
+		SetCR(0);
+		PowerPC::ppcState.fpscr = 0;
+		PowerPC::ppcState.Exceptions = 0;
+		MSR = 0x2000; // FP available
+		LR = 0;
+		CTR = 0;
+		PC = START;
+		NPC = START + 4;
+	}
+
+	struct GuestState
+	{
+		u32 gpr[32];
+		u64 fpr[32];
+		u32 cr;
+		std::vector<u32> memory;
+		u64 cycles;
+	};
+
+	GuestState SaveGuest(u64 cycles)
+	{
+		GuestState state;
+		memcpy(state.gpr, PowerPC::ppcState.gpr, sizeof(state.gpr));
+		for (int i = 0; i < 32; i++)
+			state.fpr[i] = PowerPC::ppcState.ps[i][0];
+		state.cr = GetCR();
+		for (u32 i = 0; i < BSS_WORDS; i++)
+			state.memory.push_back(Memory::Read_U32(BSS + i * 4));
+		for (u32 i = 0; i < 6; i++)
+			state.memory.push_back(Memory::Read_U32(DATA + i * 4));
+		state.cycles = cycles;
+		return state;
+	}
+
+	static void ExpectSameState(const GuestState& expected, const GuestState& actual)
+	{
+		for (int i = 0; i < 32; i++)
+			EXPECT_EQ(expected.gpr[i], actual.gpr[i]) << "r" << i;
+		for (int i = 0; i < 32; i++)
+			EXPECT_EQ(expected.fpr[i], actual.fpr[i]) << "f" << i;
+		EXPECT_EQ(expected.cr, actual.cr);
+		EXPECT_TRUE(expected.memory == actual.memory);
+		EXPECT_EQ(expected.cycles, actual.cycles);
+	}
+
+	GuestState RunInterpreter()
+	{
+		LoadGuest();
+		u64 cycles = 0;
+		while (PC != Address(30))
+			cycles += Interpreter::getInstance()->SingleStepInner();
+		return SaveGuest(cycles);
+	}
+
+	GuestState RunCached()
+	{
+		LoadGuest();
+		u64 cycles = 0;
+		while (PC != Address(30))
+			cycles += m_cached->RunBlock();
+		return SaveGuest(cycles);
+	}
+
+	std::unique_ptr<u8[]> m_ram;
+	// Embeds a whole block cache, so it's far too big for the stack.
+	std::unique_ptr<CachedInterpreter> m_cached;
+	std::vector<u32> m_program;
+};
+
+TEST_F(CachedInterpreterTest, MatchesInterpreter)
+{
+	GuestState expected = RunInterpreter();
+	// The cror made the beq skip over the li.
+	EXPECT_EQ(0u, expected.gpr[21]);
+	EXPECT_EQ(expected.memory[0x100], Memory::Read_U32(DATA + 0x400));
+
+	ExpectSameState(expected, RunCached());
+
+	// Again, from the cached blocks this time.
+	ExpectSameState(expected, RunCached());
+}
+
+TEST_F(CachedInterpreterTest, Invalidation)
+{
+	GuestState original = RunCached();
+
+	// Change the checksum function the way a game would load new code: write it and icbi.
+	m_program[36] = add(10, 10, 11);
+	GuestState expected = RunInterpreter();
+	EXPECT_NE(original.gpr[20], expected.gpr[20]);
+
+	JitInterface::InvalidateICache(Address(36), 4, true);
+	ExpectSameState(expected, RunCached());
+}
+
+TEST_F(CachedInterpreterTest, Breakpoint)
+{
+	RunCached();
+
+	// The breakpoint is in the middle of an already compiled block.
+	SConfig::GetInstance().m_LocalCoreStartupParameter.bEnableDebugging = true;
+	PowerPC::breakpoints.Add(Address(17));
+
+	LoadGuest();
+	while (PC != Address(17) && PC != Address(30))
+		m_cached->RunBlock();
+	EXPECT_EQ(Address(17), PC);
+	EXPECT_EQ(BSS, PowerPC::ppcState.gpr[3]);
+	EXPECT_NE((u32)COPY_WORDS, PowerPC::ppcState.gpr[4]);
+}
+
+TEST_F(CachedInterpreterTest, Benchmark)
+{
+	const int RUNS = 100;
+
+	auto start = std::chrono::high_resolution_clock::now();
+	GuestState expected;
+	for (int i = 0; i < RUNS; i++)
+		expected = RunInterpreter();
+	auto interpreted = std::chrono::high_resolution_clock::now();
+	GuestState actual;
+	for (int i = 0; i < RUNS; i++)
+		actual = RunCached();
+	auto cached = std::chrono::high_resolution_clock::now();
+
+	ExpectSameState(expected, actual);
+
+	#define AS_US(diff) ((unsigned long long)std::chrono::duration_cast<std::chrono::microseconds>(diff).count())
+
+	printf("boot sequence, %d runs of %llu cycles:\n", RUNS, (unsigned long long)expected.cycles);
+	printf("  interpreter:        %llu us\n", AS_US(interpreted - start));
+	printf("  cached interpreter: %llu us\n", AS_US(cached - interpreted));
+}
@@ -0,0 +1,213 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Common/ChunkFile.h"
+#include "Common/CommonTypes.h"
+#include "Core/CoreTiming.h"
+#include "Core/PowerPC/PowerPC.h"
+
+// Which events ran, as (userdata, cyclesLate).
+static std::vector<std::pair<u64, int>> s_callbacks;
+
+static void RecordCallback(u64 userdata, int cyclesLate)
+{
+	s_callbacks.emplace_back(userdata, cyclesLate);
+}
+
+static void OtherCallback(u64 userdata, int cyclesLate)
+{
+	s_callbacks.emplace_back(userdata | 0x10000, cyclesLate);
+}
+
+class CoreTimingTest : public testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		s_callbacks.clear();
+		CoreTiming::Init();
+		m_record = CoreTiming::RegisterEvent("Record", RecordCallback);
+		m_other = CoreTiming::RegisterEvent("Other", OtherCallback);
+	}
+
+	void TearDown() override
+	{
+		CoreTiming::Shutdown();
+	}
+
+	// Pretends the CPU ran until the given tick and lets the scheduler catch up.
+	static void AdvanceTo(s64 ticks)
+	{
+		PowerPC::ppcState.downcount = CoreTiming::slicelength - (int)(ticks - CoreTiming::globalTimer);
+		CoreTiming::Advance();
+	}
+
+	int m_record;
+	int m_other;
+};
+
+TEST_F(CoreTimingTest, Order)
+{
+	CoreTiming::ScheduleEvent(300, m_record, 3);
+	CoreTiming::ScheduleEvent(100, m_record, 1);
+	CoreTiming::ScheduleEvent(200, m_record, 2);
+	// Same time as the first one; must run after it.
+	CoreTiming::ScheduleEvent(100, m_other, 1);
+
+	AdvanceTo(50);
+	EXPECT_TRUE(s_callbacks.empty());
+	// The slice ends at the next event.
+	EXPECT_EQ(50, CoreTiming::slicelength);
+
+	AdvanceTo(120);
+	ASSERT_EQ(2u, s_callbacks.size());
+	EXPECT_EQ(std::make_pair((u64)1, 20), s_callbacks[0]);
+	EXPECT_EQ(std::make_pair((u64)0x10001, 20), s_callbacks[1]);
+
+	AdvanceTo(300);
+	ASSERT_EQ(4u, s_callbacks.size());
+	EXPECT_EQ(std::make_pair((u64)2, 100), s_callbacks[2]);
+	EXPECT_EQ(std::make_pair((u64)3, 0), s_callbacks[3]);
+	EXPECT_FALSE(CoreTiming::IsScheduled(m_record));
+}
+
+TEST_F(CoreTimingTest, RemoveEvent)
+{
+	for (u64 i = 0; i < 10; i++)
+	{
+		CoreTiming::ScheduleEvent((int)(100 - i * 10), m_record, i);
+		CoreTiming::ScheduleEvent((int)(100 - i * 10), m_other, i);
+	}
+	EXPECT_TRUE(CoreTiming::IsScheduled(m_record));
+
+	CoreTiming::RemoveEvent(m_record);
+	EXPECT_FALSE(CoreTiming::IsScheduled(m_record));
+	EXPECT_TRUE(CoreTiming::IsScheduled(m_other));
+
+	AdvanceTo(100);
+	ASSERT_EQ(10u, s_callbacks.size());
+	for (u64 i = 0; i < 10; i++)
+		EXPECT_EQ(0x10000 | (9 - i), s_callbacks[i].first);
+}
+
+TEST_F(CoreTimingTest, Threadsafe)
+{
+	const int THREADS = 4;
+	const u64 EVENTS = 10000;
+
+	std::vector<std::thread> threads;
+	for (int t = 0; t < THREADS; t++)
+	{
+		threads.emplace_back([this, t, EVENTS] {
+			for (u64 i = 0; i < EVENTS; i++)
+				CoreTiming::ScheduleEvent_Threadsafe(0, m_record, ((u64)t << 32) | i);
+		});
+	}
+	for (auto& thread : threads)
+		thread.join();
+
+	AdvanceTo(0);
+	ASSERT_EQ(THREADS * EVENTS, s_callbacks.size());
+
+	// Events from one thread run in the order that thread scheduled them in.
+	u64 next[THREADS] = {};
+	for (const auto& callback : s_callbacks)
+	{
+		int t = (int)(callback.first >> 32);
+		ASSERT_LT(t, THREADS);
+		EXPECT_EQ(next[t]++, callback.first & 0xFFFFFFFF);
+	}
+}
+
+TEST_F(CoreTimingTest, SaveState)
+{
+	CoreTiming::ScheduleEvent(200, m_other, 2);
+	CoreTiming::ScheduleEvent(100, m_record, 1);
+	CoreTiming::ScheduleEvent(100, m_other, 1);
+	CoreTiming::ScheduleEvent_Threadsafe(100, m_record, 3);
+	CoreTiming::ScheduleEvent(150, m_record, 4);
+
+	u8* ptr = nullptr;
+	PointerWrap measure(&ptr, PointerWrap::MODE_MEASURE);
+	CoreTiming::DoState(measure);
+	std::vector<u8> state(reinterpret_cast<size_t>(ptr));
+
+	ptr = state.data();
+	PointerWrap write(&ptr, PointerWrap::MODE_WRITE);
+	CoreTiming::DoState(write);
+	ASSERT_EQ(state.data() + state.size(), ptr);
+
+	AdvanceTo(300);
+	std::vector<std::pair<u64, int>> expected = std::move(s_callbacks);
+	ASSERT_EQ(5u, expected.size());
+
+	// Load into a scheduler that knows the types in a different order.
+	CoreTiming::Shutdown();
+	s_callbacks.clear();
+	CoreTiming::Init();
+	m_other = CoreTiming::RegisterEvent("Other", OtherCallback);
+	m_record = CoreTiming::RegisterEvent("Record", RecordCallback);
+	// Something due before the loaded events, which has to go away.
+	CoreTiming::ScheduleEvent(10, m_record, 0xFF);
+
+	ptr = state.data();
+	PointerWrap read(&ptr, PointerWrap::MODE_READ);
+	CoreTiming::DoState(read);
+	ASSERT_EQ(PointerWrap::MODE_READ, read.GetMode());
+	EXPECT_EQ(0, CoreTiming::globalTimer);
+
+	// Something due at the same time as loaded events, which has to run after them.
+	CoreTiming::ScheduleEvent(100, m_record, 5);
+	expected.insert(expected.begin() + 3, std::make_pair((u64)5, 200));
+
+	AdvanceTo(300);
+	EXPECT_EQ(expected, s_callbacks);
+}
+
+static int s_periodic_event;
+
+static void PeriodicCallback(u64 userdata, int cyclesLate)
+{
+	// Like the timers in HW/SystemTimers.cpp, with a period that depends on the event.
+	CoreTiming::ScheduleEvent((int)(100 + userdata * 37) - cyclesLate, s_periodic_event, userdata);
+}
+
+TEST_F(CoreTimingTest, Benchmark)
+{
+	const u64 PERIODIC = 32;
+	const int PENDING = 1000;
+	const int ADVANCES = 200000;
+
+	s_periodic_event = CoreTiming::RegisterEvent("Periodic", PeriodicCallback);
+	for (u64 i = 0; i < PERIODIC; i++)
+		CoreTiming::ScheduleEvent((int)i, s_periodic_event, i);
+	// Things like disc reads and timeouts, which are far off but take up space in the queue.
+	for (int i = 0; i < PENDING; i++)
+		CoreTiming::ScheduleEvent(0x40000000 + i, m_record, i);
+
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < ADVANCES; i++)
+	{
+		PowerPC::ppcState.downcount = 0;
+		CoreTiming::Advance();
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+
+	EXPECT_TRUE(s_callbacks.empty());
+	EXPECT_TRUE(CoreTiming::IsScheduled(s_periodic_event));
+	CoreTiming::ClearPendingEvents();
+
+	#define AS_US(diff) ((unsigned long long)std::chrono::duration_cast<std::chrono::microseconds>(diff).count())
+
+	printf("%d advances with %llu periodic and %d pending events, up to tick %lld:\n",
+	       ADVANCES, (unsigned long long)PERIODIC, PENDING, (long long)CoreTiming::globalTimer);
+	printf("  scheduler: %llu us\n", AS_US(end - start));
+}
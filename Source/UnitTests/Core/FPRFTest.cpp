@@ -0,0 +1,134 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include "Common/CommonTypes.h"
+#include "Common/MathUtil.h"
+#include "Common/x64ABI.h"
+#include "Core/PowerPC/Gekko.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "Core/PowerPC/Interpreter/Interpreter.h"
+#include "Core/PowerPC/Interpreter/Interpreter_FPUtils.h"
+#include "Core/PowerPC/JitCommon/JitBase.h"
+#include "Core/PowerPC/JitCommon/Jit_Util.h"
+
+// include order is important
+#include <gtest/gtest.h>
+
+using namespace Gen;
+
+// Emits the JIT's FPRF update on its own, so that the lazily computed FPRF can be compared against
+// what the interpreter computes for the same value.
+class FPRFTestCode : public EmuCodeBlock
+{
+public:
+	FPRFTestCode()
+	{
+		AllocCodeSpace(4096);
+		SetFPRFFromJit = (void (*)(u64))GetCodePtr();
+		ABI_PushRegistersAndAdjustStack({RPPCSTATE}, 8);
+		MOV(64, R(RPPCSTATE), ImmPtr((u8*)&PowerPC::ppcState + 0x80));
+		MOVQ_xmm(XMM0, R(ABI_PARAM1));
+		SetFPRF(XMM0);
+		ABI_PopRegistersAndAdjustStack({RPPCSTATE}, 8);
+		RET();
+	}
+
+	~FPRFTestCode()
+	{
+		FreeCodeSpace();
+	}
+
+	void (*SetFPRFFromJit)(u64 value);
+};
+
+static const u64 test_values[] = {
+	0x3FF0000000000000ULL, // 1.0
+	0xC000000000000000ULL, // -2.0
+	0x0000000000000000ULL, // +0.0
+	0x8000000000000000ULL, // -0.0
+	0x0000000000000001ULL, // smallest positive denormal
+	0x800FFFFFFFFFFFFFULL, // largest negative denormal
+	0x7FF0000000000000ULL, // +inf
+	0xFFF0000000000000ULL, // -inf
+	0x7FF8000000000000ULL, // QNaN
+	0xFFF0000000000001ULL, // SNaN
+	0x380FFFFFE0000000ULL, // float denormal, double normal
+};
+
+class FPRFTest : public testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		PowerPC::ppcState.fpscr = 0;
+		PowerPC::ppcState.fprf_pending = 0;
+	}
+
+	static u32 InterpreterFPRF(u64 value)
+	{
+		PowerPC::ppcState.fpscr = 0;
+		UpdateFPRF(MathUtil::IntDouble(value).d);
+		return FPSCR.FPRF;
+	}
+
+	// Reads FPSCR the way a game would, through mffs.
+	static u32 ReadFPSCR()
+	{
+		UGeckoInstruction inst;
+		inst.hex = 0;
+		inst.FD = 1;
+		Interpreter::mffsx(inst);
+		return (u32)riPS0(1);
+	}
+
+	FPRFTestCode m_code;
+};
+
+TEST_F(FPRFTest, LazyMatchesInterpreter)
+{
+	for (u64 value : test_values)
+	{
+		u32 expected = InterpreterFPRF(value);
+
+		// Start from a stale FPRF with some unrelated bits set, which must survive.
+		PowerPC::ppcState.fpscr = FPRF_MASK | FPSCR_ZX | 3;
+		m_code.SetFPRFFromJit(value);
+		EXPECT_EQ(1, PowerPC::ppcState.fprf_pending);
+
+		u32 fpscr = ReadFPSCR();
+		EXPECT_EQ(expected, (fpscr & FPRF_MASK) >> FPRF_SHIFT) << std::hex << value;
+		EXPECT_EQ((u32)(FPSCR_ZX | 3), fpscr & (FPSCR_ZX | 3));
+		EXPECT_EQ(0, PowerPC::ppcState.fprf_pending);
+	}
+}
+
+TEST_F(FPRFTest, LaterInterpreterWriteWins)
+{
+	m_code.SetFPRFFromJit(0xFFF0000000000000ULL);
+
+	// fcmpu replaces all of FPRF; the deferred -inf must not come back afterwards.
+	PowerPC::ppcState.ps[2][0] = MathUtil::IntDouble(1.0).i;
+	PowerPC::ppcState.ps[3][0] = MathUtil::IntDouble(2.0).i;
+	UGeckoInstruction inst;
+	inst.hex = 0;
+	inst.FA = 2;
+	inst.FB = 3;
+	Interpreter::fcmpu(inst);
+
+	EXPECT_EQ((u32)FPCC::FL, (ReadFPSCR() & FPRF_MASK) >> FPRF_SHIFT);
+}
+
+TEST_F(FPRFTest, PartialWriteSeesDeferredValue)
+{
+	// A negative denormal is classified as C | FL. Clearing just C with mtfsb0 has to keep FL,
+	// which only exists once the deferred value has been classified.
+	m_code.SetFPRFFromJit(0x800FFFFFFFFFFFFFULL);
+
+	UGeckoInstruction inst;
+	inst.hex = 0;
+	inst.CRBD = 15;
+	Interpreter::mtfsb0x(inst);
+
+	EXPECT_EQ((u32)FPCC::FL, (ReadFPSCR() & FPRF_MASK) >> FPRF_SHIFT);
+}
@@ -0,0 +1,410 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/MathUtil.h"
+#include "Core/ConfigManager.h"
+#include "Core/HLE/HLE.h"
+#include "Core/HLE/HLE_SDK.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "Core/PowerPC/PPCTables.h"
+#include "Core/PowerPC/Interpreter/Interpreter.h"
+
+// Instruction encodings for the guest versions of the functions below.
+static u32 psq_l(u32 d, u32 a, s32 offset, u32 w = 0) { return (56u << 26) | (d << 21) | (a << 16) | (w << 15) | (offset & 0xfff); }
+static u32 psq_st(u32 s, u32 a, s32 offset, u32 w = 0) { return (60u << 26) | (s << 21) | (a << 16) | (w << 15) | (offset & 0xfff); }
+static u32 PS(u32 xo, u32 d, u32 a, u32 b, u32 c) { return (4u << 26) | (d << 21) | (a << 16) | (b << 11) | (c << 6) | (xo << 1); }
+static u32 ps_sum0(u32 d, u32 a, u32 c, u32 b) { return PS(10, d, a, b, c); }
+static u32 ps_muls0(u32 d, u32 a, u32 c) { return PS(12, d, a, 0, c); }
+static u32 ps_madds0(u32 d, u32 a, u32 c, u32 b) { return PS(14, d, a, b, c); }
+static u32 ps_madds1(u32 d, u32 a, u32 c, u32 b) { return PS(15, d, a, b, c); }
+static u32 ps_sub(u32 d, u32 a, u32 b) { return PS(20, d, a, b, 0); }
+static u32 ps_add(u32 d, u32 a, u32 b) { return PS(21, d, a, b, 0); }
+static u32 ps_mul(u32 d, u32 a, u32 c) { return PS(25, d, a, 0, c); }
+static u32 ps_madd(u32 d, u32 a, u32 c, u32 b) { return PS(29, d, a, b, c); }
+static const u32 blr = 0x4E800020;
+
+// The same instruction sequences as the SDK's versions.
+static std::vector<u32> PSMTXCopy()
+{
+	std::vector<u32> code;
+	for (s32 offset = 0; offset < 48; offset += 8)
+	{
+		code.push_back(psq_l(0, 3, offset));
+		code.push_back(psq_st(0, 4, offset));
+	}
+	code.push_back(blr);
+	return code;
+}
+
+static std::vector<u32> PSMTXConcat()
+{
+	// r6 points to { 0.0, 1.0 }, which the SDK loads from its data section.
+	std::vector<u32> code = {
+		psq_l(6, 4, 0), psq_l(7, 4, 8), psq_l(8, 4, 16), psq_l(9, 4, 24),
+		psq_l(10, 4, 32), psq_l(11, 4, 40), psq_l(13, 6, 0),
+	};
+	for (s32 row = 0; row < 48; row += 16)
+	{
+		std::vector<u32> row_code = {
+			psq_l(0, 3, row), psq_l(1, 3, row + 8),
+			ps_muls0(2, 6, 0), ps_madds1(2, 8, 0, 2), ps_madds0(2, 10, 1, 2),
+			ps_muls0(3, 7, 0), ps_madds1(3, 9, 0, 3), ps_madds0(3, 11, 1, 3), ps_madds1(3, 13, 1, 3),
+			psq_st(2, 5, row), psq_st(3, 5, row + 8),
+		};
+		code.insert(code.end(), row_code.begin(), row_code.end());
+	}
+	code.push_back(blr);
+	return code;
+}
+
+static std::vector<u32> PSMTXMultVec()
+{
+	std::vector<u32> code = { psq_l(0, 4, 0), psq_l(1, 4, 8, 1) };
+	for (s32 row = 0; row < 3; row++)
+	{
+		std::vector<u32> row_code = {
+			psq_l(2, 3, row * 16), psq_l(3, 3, row * 16 + 8),
+			ps_mul(4, 2, 0), ps_madd(5, 3, 1, 4), ps_sum0(6, 5, 6, 5),
+			psq_st(6, 5, row * 4, 1),
+		};
+		code.insert(code.end(), row_code.begin(), row_code.end());
+	}
+	code.push_back(blr);
+	return code;
+}
+
+static std::vector<u32> PSVECAdd(bool subtract)
+{
+	return {
+		psq_l(2, 3, 0), psq_l(4, 4, 0), subtract ? ps_sub(6, 2, 4) : ps_add(6, 2, 4), psq_st(6, 5, 0),
+		psq_l(3, 3, 8, 1), psq_l(5, 4, 8, 1), subtract ? ps_sub(7, 3, 5) : ps_add(7, 3, 5), psq_st(7, 5, 8, 1),
+		blr,
+	};
+}
+
+static std::vector<u32> PSVECScale()
+{
+	return {
+		psq_l(0, 3, 0), psq_l(2, 3, 8, 1),
+		ps_muls0(0, 0, 1), psq_st(0, 4, 0),
+		ps_muls0(0, 2, 1), psq_st(0, 4, 8, 1),
+		blr,
+	};
+}
+
+static std::vector<u32> PSVECDotProduct()
+{
+	return {
+		psq_l(2, 3, 4), psq_l(3, 4, 4), ps_mul(2, 2, 3),
+		psq_l(5, 3, 0), psq_l(4, 4, 0), ps_madd(3, 5, 4, 2),
+		ps_sum0(1, 3, 2, 2),
+		blr,
+	};
+}
+
+class HLESDKTest : public testing::Test
+{
+protected:
+	enum : u32
+	{
+		RETURN = 0x80003000,
+		CODE = 0x80004000,
+		A = 0x80010000,
+		B = 0x80010100,
+		C = 0x80010200,
+		UNIT = 0x80010300,
+	};
+
+	static void SetUpTestCase()
+	{
+		// Never shut down, since that would save the settings to the user directory.
+		SConfig::Init();
+	}
+
+	void SetUp() override
+	{
+		SConfig::GetInstance().m_LocalCoreStartupParameter.bMMU = false;
+		SConfig::GetInstance().m_LocalCoreStartupParameter.bHLE_SDK = true;
+		PPCTables::InitTables(SCoreStartupParameter::CORE_INTERPRETER);
+
+		// Memory::Init() needs a video backend for the MMIO handlers, and
+		// nothing here touches MMIO, so just provide a GameCube's worth of RAM.
+		m_ram.reset(new u8[Memory::RAM_SIZE]());
+		Memory::m_pRAM = m_ram.get();
+		Memory::base = m_ram.get();
+		Memory::m_pEXRAM = nullptr;
+		Memory::bFakeVMEM = false;
+
+		// No symbols, so this removes all hooks.
+		HLE::PatchFunctions();
+
+		memset(PowerPC::ppcState.ps, 0, sizeof(PowerPC::ppcState.ps));
+		for (int i = 0; i < 8; i++)
+			GQR(i) = 0;
+		PowerPC::ppcState.fpscr = 0;
+		PowerPC::ppcState.Exceptions = 0;
+		MSR = 0x2000; // FP available
+
+		Memory::Write_U32(0, UNIT);
+		Memory::Write_U32(0x3F800000, UNIT + 4);
+		m_seed = 1;
+	}
+
+	void TearDown() override
+	{
+		HLE::PatchFunctions();
+		SConfig::GetInstance().m_LocalCoreStartupParameter.bHLE_SDK = false;
+		Memory::m_pRAM = nullptr;
+		Memory::base = nullptr;
+	}
+
+	// Floats of all magnitudes, with some zeros and denormals in between.
+	u32 RandomFloat()
+	{
+		m_seed = m_seed * 1103515245 + 12345;
+		u32 bits = m_seed >> 1;
+		switch (bits % 16)
+		{
+		case 0:
+			return (bits & 0x80000000) ? 0x80000000 : 0;
+		case 1:
+			return bits & 0x807FFFFF;
+		default:
+			// Exponents that can't overflow when multiplied and added together.
+			return (bits & 0x807FFFFF) | (((bits >> 8) % 160 + 48) << 23);
+		}
+	}
+
+	void WriteRandom(u32 address, u32 count)
+	{
+		for (u32 i = 0; i < count; i++)
+			Memory::Write_U32(RandomFloat(), address + i * 4);
+	}
+
+	std::vector<u32> ReadWords(u32 address, u32 count)
+	{
+		std::vector<u32> words;
+		for (u32 i = 0; i < count; i++)
+			words.push_back(Memory::Read_U32(address + i * 4));
+		return words;
+	}
+
+	void SetArguments(u32 r3, u32 r4, u32 r5 = 0)
+	{
+		GPR(3) = r3;
+		GPR(4) = r4;
+		GPR(5) = r5;
+		GPR(6) = UNIT;
+		LR = RETURN;
+		PC = CODE;
+		NPC = CODE + 4;
+	}
+
+	static void RunGuest(const std::vector<u32>& code)
+	{
+		for (u32 i = 0; i < code.size(); i++)
+			Memory::Write_U32(code[i], CODE + i * 4);
+		while (PC != RETURN)
+			Interpreter::getInstance()->SingleStepInner();
+	}
+
+	static void RunHLE(void (*function)())
+	{
+		function();
+		EXPECT_EQ((u32)RETURN, NPC);
+	}
+
+	std::unique_ptr<u8[]> m_ram;
+	u32 m_seed;
+};
+
+TEST_F(HLESDKTest, PSMTXConcat)
+{
+	for (int i = 0; i < 1000; i++)
+	{
+		WriteRandom(A, 12);
+		WriteRandom(B, 12);
+
+		SetArguments(A, B, C);
+		RunGuest(PSMTXConcat());
+		std::vector<u32> expected = ReadWords(C, 12);
+
+		// The result overwrites one of the sources, which games do all the time.
+		SetArguments(A, B, B);
+		RunHLE(HLE_SDK::HLE_PSMTXConcat);
+		ASSERT_EQ(expected, ReadWords(B, 12)) << "iteration " << i;
+	}
+}
+
+TEST_F(HLESDKTest, PSMTXMultVec)
+{
+	for (int i = 0; i < 1000; i++)
+	{
+		WriteRandom(A, 12);
+		WriteRandom(B, 3);
+
+		SetArguments(A, B, C);
+		RunGuest(PSMTXMultVec());
+		std::vector<u32> expected = ReadWords(C, 3);
+
+		Memory::Write_U32(0xDEADBEEF, C);
+		SetArguments(A, B, C);
+		RunHLE(HLE_SDK::HLE_PSMTXMultVec);
+		ASSERT_EQ(expected, ReadWords(C, 3)) << "iteration " << i;
+	}
+}
+
+TEST_F(HLESDKTest, PSVEC)
+{
+	for (int i = 0; i < 1000; i++)
+	{
+		WriteRandom(A, 3);
+		WriteRandom(B, 3);
+		// Not necessarily a single precision value.
+		rPS0(1) = MathUtil::IntFloat(RandomFloat()).f * (1.0 + 1.0 / 0x1000000);
+
+		for (bool subtract : { false, true })
+		{
+			SetArguments(A, B, C);
+			RunGuest(PSVECAdd(subtract));
+			std::vector<u32> expected = ReadWords(C, 3);
+			SetArguments(A, B, C + 0x10);
+			RunHLE(subtract ? HLE_SDK::HLE_PSVECSubtract : HLE_SDK::HLE_PSVECAdd);
+			ASSERT_EQ(expected, ReadWords(C + 0x10, 3)) << "iteration " << i;
+		}
+
+		double scale = rPS0(1);
+		SetArguments(A, C);
+		RunGuest(PSVECScale());
+		std::vector<u32> expected = ReadWords(C, 3);
+		rPS0(1) = scale;
+		SetArguments(A, C + 0x10);
+		RunHLE(HLE_SDK::HLE_PSVECScale);
+		ASSERT_EQ(expected, ReadWords(C + 0x10, 3)) << "iteration " << i;
+
+		SetArguments(A, B);
+		RunGuest(PSVECDotProduct());
+		u64 expected_ps0 = riPS0(1), expected_ps1 = riPS1(1);
+		rPS0(1) = rPS1(1) = 0.0;
+		SetArguments(A, B);
+		RunHLE(HLE_SDK::HLE_PSVECDotProduct);
+		ASSERT_EQ(expected_ps0, riPS0(1)) << "iteration " << i;
+		ASSERT_EQ(expected_ps1, riPS1(1)) << "iteration " << i;
+	}
+}
+
+TEST_F(HLESDKTest, PSMTXIdentityAndCopy)
+{
+	for (int i = 0; i < 100; i++)
+	{
+		WriteRandom(A, 12);
+		SetArguments(A, B);
+		RunGuest(PSMTXCopy());
+		std::vector<u32> expected = ReadWords(B, 12);
+		SetArguments(A, C);
+		RunHLE(HLE_SDK::HLE_PSMTXCopy);
+		ASSERT_EQ(expected, ReadWords(C, 12)) << "iteration " << i;
+	}
+
+	SetArguments(A, 0);
+	RunHLE(HLE_SDK::HLE_PSMTXIdentity);
+	for (u32 i = 0; i < 12; i++)
+		EXPECT_EQ(i % 5 == 0 ? 0x3F800000u : 0u, Memory::Read_U32(A + i * 4)) << i;
+}
+
+TEST_F(HLESDKTest, Memory)
+{
+	for (u32 i = 0; i < 64; i++)
+		Memory::Write_U8(i, A + i);
+
+	SetArguments(B + 3, 0x5A, 20);
+	RunHLE(HLE_SDK::HLE_memset);
+	EXPECT_EQ(B + 3, GPR(3));
+	EXPECT_EQ(0u, Memory::Read_U8(B + 2));
+	EXPECT_EQ(0x5Au, Memory::Read_U8(B + 3));
+	EXPECT_EQ(0x5Au, Memory::Read_U8(B + 22));
+	EXPECT_EQ(0u, Memory::Read_U8(B + 23));
+
+	// Overlapping copies in both directions end up like memmove.
+	SetArguments(A + 8, A, 32);
+	RunHLE(HLE_SDK::HLE_memcpy);
+	EXPECT_EQ(A + 8, GPR(3));
+	for (u32 i = 0; i < 32; i++)
+		EXPECT_EQ(i, Memory::Read_U8(A + 8 + i));
+
+	SetArguments(A, A + 8, 32);
+	RunHLE(HLE_SDK::HLE_memcpy);
+	for (u32 i = 0; i < 32; i++)
+		EXPECT_EQ(i, Memory::Read_U8(A + i));
+
+	// Nothing to check without a JIT, other than that they return.
+	SetArguments(A + 5, 100);
+	RunHLE(HLE_SDK::HLE_DCFlushRange);
+	SetArguments(A + 5, 100);
+	RunHLE(HLE_SDK::HLE_DCInvalidateRange);
+}
+
+TEST_F(HLESDKTest, Hook)
+{
+	std::vector<u32> code = PSMTXConcat();
+	for (u32 i = 0; i < code.size(); i++)
+		Memory::Write_U32(code[i], CODE + i * 4);
+	HLE::Patch(CODE, "PSMTXConcat");
+
+	WriteRandom(A, 12);
+	WriteRandom(B, 12);
+	SetArguments(A, B, C);
+	RunGuest(code);
+	std::vector<u32> expected = ReadWords(C, 12);
+	Memory::Write_U32(0xDEADBEEF, C);
+
+	// A single step runs the whole function.
+	SetArguments(A, B, C);
+	Interpreter::getInstance()->SingleStepInner();
+	EXPECT_EQ((u32)RETURN, PC);
+	EXPECT_EQ(expected, ReadWords(C, 12));
+
+	// Unless it's turned off.
+	SConfig::GetInstance().m_LocalCoreStartupParameter.bHLE_SDK = false;
+	SetArguments(A, B, C);
+	Interpreter::getInstance()->SingleStepInner();
+	EXPECT_EQ((u32)CODE + 4, PC);
+}
+
+TEST_F(HLESDKTest, Benchmark)
+{
+	const int RUNS = 100000;
+	std::vector<u32> code = PSMTXConcat();
+	WriteRandom(A, 12);
+	WriteRandom(B, 12);
+
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < RUNS; i++)
+	{
+		SetArguments(A, B, C);
+		RunGuest(code);
+	}
+	auto interpreted = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < RUNS; i++)
+	{
+		SetArguments(A, B, C);
+		HLE_SDK::HLE_PSMTXConcat();
+	}
+	auto hle = std::chrono::high_resolution_clock::now();
+
+	#define AS_US(diff) ((unsigned long long)std::chrono::duration_cast<std::chrono::microseconds>(diff).count())
+
+	printf("PSMTXConcat, %d runs:\n", RUNS);
+	printf("  interpreter: %llu us\n", AS_US(interpreted - start));
+	printf("  HLE:         %llu us\n", AS_US(hle - interpreted));
+}
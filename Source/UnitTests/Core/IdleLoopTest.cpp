@@ -0,0 +1,181 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <memory>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Core/ConfigManager.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "Core/PowerPC/PPCAnalyst.h"
+#include "Core/PowerPC/PPCTables.h"
+
+// Wait loops as they show up in games, and loops that look like them but make progress.
+class IdleLoopTest : public testing::Test
+{
+protected:
+	enum : u32
+	{
+		START = 0x80004000,
+	};
+
+	static void SetUpTestCase()
+	{
+		// Never shut down, since that would save the settings to the user directory.
+		SConfig::Init();
+	}
+
+	void SetUp() override
+	{
+		SConfig::GetInstance().m_LocalCoreStartupParameter.bMMU = false;
+		PPCTables::InitTables(SCoreStartupParameter::CORE_INTERPRETER);
+
+		// Memory::Init() needs a video backend for the MMIO handlers, and
+		// nothing here touches MMIO, so just provide a GameCube's worth of RAM.
+		m_ram.reset(new u8[Memory::RAM_SIZE]());
+		Memory::m_pRAM = m_ram.get();
+		Memory::base = m_ram.get();
+		Memory::m_pEXRAM = nullptr;
+		Memory::bFakeVMEM = false;
+
+		m_block.m_stats = &m_stats;
+		m_block.m_gpa = &m_gpa;
+		m_block.m_fpa = &m_fpa;
+	}
+
+	void TearDown() override
+	{
+		Memory::m_pRAM = nullptr;
+		Memory::base = nullptr;
+	}
+
+	// Returns whether the analyzer marks the first branch of the code as an idle loop.
+	bool IsIdleLoop(const std::vector<u32>& code)
+	{
+		for (u32 i = 0; i < code.size(); i++)
+			Memory::Write_U32(code[i], START + i * 4);
+		// Something to fall through to when the loop isn't a whole block.
+		Memory::Write_U32(0x4E800020, START + (u32)code.size() * 4); // blr
+
+		PPCAnalyst::CodeBuffer buffer(32000);
+		m_analyzer.Analyze(START, &m_block, &buffer, buffer.GetSize());
+		for (u32 i = 0; i < m_block.m_num_instructions; i++)
+		{
+			if (buffer.codebuffer[i].opinfo->flags & FL_ENDBLOCK)
+				return buffer.codebuffer[i].branchIsIdleLoop;
+		}
+		return false;
+	}
+
+	std::unique_ptr<u8[]> m_ram;
+	PPCAnalyst::PPCAnalyzer m_analyzer;
+	PPCAnalyst::CodeBlock m_block;
+	PPCAnalyst::BlockStats m_stats;
+	PPCAnalyst::BlockRegStats m_gpa;
+	PPCAnalyst::BlockRegStats m_fpa;
+};
+
+TEST_F(IdleLoopTest, SmallDataFlag)
+{
+	// The loop the old lwz special case used to look for.
+	EXPECT_TRUE(IsIdleLoop({
+		0x800D8030, // lwz r0, -0x7fd0(r13)
+		0x28000000, // cmplwi r0, 0
+		0x4182FFF8, // beq -8
+	}));
+}
+
+TEST_F(IdleLoopTest, RetraceCount)
+{
+	// Waits for the retrace count in memory to move on from the one in r31.
+	EXPECT_TRUE(IsIdleLoop({
+		0x809E0000, // lwz r4, 0(r30)
+		0x7C04F840, // cmplw r4, r31
+		0x4182FFF8, // beq -8
+	}));
+}
+
+TEST_F(IdleLoopTest, MailboxPolling)
+{
+	// Polls the DSP mailbox status through a pointer to the hardware registers.
+	EXPECT_TRUE(IsIdleLoop({
+		0xA0035004, // lhz r0, 0x5004(r3)
+		0x5400042F, // rlwinm. r0, r0, 0, 16, 23
+		0x4182FFF8, // beq -8
+	}));
+}
+
+TEST_F(IdleLoopTest, BranchToSelf)
+{
+	EXPECT_TRUE(IsIdleLoop({
+		0x48000000, // b .
+	}));
+}
+
+TEST_F(IdleLoopTest, Counter)
+{
+	EXPECT_FALSE(IsIdleLoop({
+		0x38630001, // addi r3, r3, 1
+		0x2C030064, // cmpwi r3, 100
+		0x4180FFF8, // blt -8
+	}));
+}
+
+TEST_F(IdleLoopTest, PointerChase)
+{
+	// Every iteration loads from a different address.
+	EXPECT_FALSE(IsIdleLoop({
+		0x80630000, // lwz r3, 0(r3)
+		0x2C030000, // cmpwi r3, 0
+		0x4082FFF8, // bne -8
+	}));
+}
+
+TEST_F(IdleLoopTest, Store)
+{
+	EXPECT_FALSE(IsIdleLoop({
+		0x80040000, // lwz r0, 0(r4)
+		0x90050000, // stw r0, 0(r5)
+		0x2C000000, // cmpwi r0, 0
+		0x4182FFF4, // beq -12
+	}));
+}
+
+TEST_F(IdleLoopTest, DecrementingCTR)
+{
+	EXPECT_FALSE(IsIdleLoop({
+		0x80040000, // lwz r0, 0(r4)
+		0x4200FFFC, // bdnz -4
+	}));
+}
+
+TEST_F(IdleLoopTest, TimeBase)
+{
+	// Waits for time to pass, which skipping to the next event would get wrong.
+	EXPECT_FALSE(IsIdleLoop({
+		0x7C6C42E6, // mftb r3
+		0x7C032040, // cmplw r3, r4
+		0x4180FFF8, // blt -8
+	}));
+}
+
+TEST_F(IdleLoopTest, ForwardBranch)
+{
+	EXPECT_FALSE(IsIdleLoop({
+		0x80040000, // lwz r0, 0(r4)
+		0x2C000000, // cmpwi r0, 0
+		0x41820008, // beq +8
+	}));
+}
+
+TEST_F(IdleLoopTest, Call)
+{
+	EXPECT_FALSE(IsIdleLoop({
+		0x80040000, // lwz r0, 0(r4)
+		0x2C000000, // cmpwi r0, 0
+		0x4182FFF9, // beql -8
+	}));
+}
@@ -0,0 +1,232 @@
+#include <chrono>
+#include <memory>
+#include <utility>
+
+#include "Common/CommonTypes.h"
+#include "Core/PowerPC/JitCommon/JitBase.h"
+#include "Core/PowerPC/JitCommon/JitCache.h"
+
+// include order is important
+#include <gtest/gtest.h>
+
+class FakeBlockCache : public JitBaseBlockCache
+{
+private:
+	// No code is generated, so there is nothing to patch.
+	void WriteLinkBlock(u8* location, const u8* address) override {}
+	void WriteDestroyBlock(const u8* location, u32 address) override {}
+};
+
+class BlockCacheFakeJit : public JitBase
+{
+public:
+	// CPUCoreBase methods
+	void Init() override {}
+	void Shutdown() override {}
+	void ClearCache() override {}
+	void Run() override {}
+	void SingleStep() override {}
+	const char *GetName() override { return nullptr; }
+
+	// JitBase methods
+	JitBaseBlockCache *GetBlockCache() override { return m_cache; }
+	void Jit(u32 em_address) override {}
+	const CommonAsmRoutinesBase *GetAsmRoutines() override { return nullptr; }
+	bool HandleFault(uintptr_t access_address, SContext* ctx) override { return false; }
+
+	JitBaseBlockCache* m_cache;
+};
+
+class JitCacheTest : public testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		// The cache embeds the full icache mirrors, so it's far too big for the stack.
+		m_cache.reset(new FakeBlockCache());
+		m_jit.m_cache = m_cache.get();
+		jit = &m_jit;
+		m_cache->Init();
+	}
+
+	void TearDown() override
+	{
+		m_cache->Shutdown();
+		jit = nullptr;
+	}
+
+	// Creates a block of num_instructions at address, with exits to the given addresses.
+	int AddBlock(u32 address, u32 num_instructions, std::initializer_list<u32> exits)
+	{
+		int block_num = m_cache->AllocateBlock(address);
+		JitBlock* b = m_cache->GetBlock(block_num);
+		b->checkedEntry = m_code;
+		b->normalEntry = m_code;
+		b->codeSize = 0;
+		b->originalSize = num_instructions;
+		for (u32 exit : exits)
+		{
+			JitBlock::LinkData link;
+			link.exitPtrs = m_code;
+			link.exitAddress = exit;
+			link.linkStatus = false;
+			b->linkData.push_back(link);
+		}
+		m_cache->FinalizeBlock(block_num, true, m_code);
+		return block_num;
+	}
+
+	bool IsLinked(int block_num, u32 exit_address)
+	{
+		for (const JitBlock::LinkData& link : m_cache->GetBlock(block_num)->linkData)
+		{
+			if (link.exitAddress == exit_address)
+				return link.linkStatus;
+		}
+		return false;
+	}
+
+	BlockCacheFakeJit m_jit;
+	std::unique_ptr<FakeBlockCache> m_cache;
+	u8 m_code[16];
+};
+
+TEST_F(JitCacheTest, LinkAndUnlink)
+{
+	int a = AddBlock(0x80003000, 4, { 0x80003100 });
+	EXPECT_FALSE(IsLinked(a, 0x80003100));
+
+	int b = AddBlock(0x80003100, 4, { 0x80003000 });
+	EXPECT_TRUE(IsLinked(a, 0x80003100));
+	EXPECT_TRUE(IsLinked(b, 0x80003000));
+
+	m_cache->InvalidateICache(0x80003100, 32, false);
+	EXPECT_EQ(-1, m_cache->GetBlockNumberFromStartAddress(0x80003100));
+	EXPECT_FALSE(IsLinked(a, 0x80003100));
+	EXPECT_EQ(a, m_cache->GetBlockNumberFromStartAddress(0x80003000));
+}
+
+TEST_F(JitCacheTest, InvalidateOverlapping)
+{
+	// A block that spans a page boundary, one that ends inside it, and one
+	// that is merely nearby.
+	int spanning = AddBlock(0x80003FF0, 8, {});
+	int before = AddBlock(0x80003F00, 4, {});
+	int after = AddBlock(0x80004100, 4, {});
+
+	m_cache->InvalidateICache(0x80004000, 32, true);
+	EXPECT_EQ(-1, m_cache->GetBlockNumberFromStartAddress(0x80003FF0));
+	EXPECT_EQ(before, m_cache->GetBlockNumberFromStartAddress(0x80003F00));
+	EXPECT_EQ(after, m_cache->GetBlockNumberFromStartAddress(0x80004100));
+
+	// The spanning block is still referenced from the other page; invalidating
+	// that page must not destroy it again.
+	m_cache->InvalidateICache(0x80003FE0, 32, true);
+	EXPECT_TRUE(m_cache->GetBlock(spanning)->invalid);
+	EXPECT_EQ(before, m_cache->GetBlockNumberFromStartAddress(0x80003F00));
+}
+
+TEST_F(JitCacheTest, RecompileWithFollowedBranches)
+{
+	int caller = AddBlock(0x80003000, 4, { 0x80005000 });
+	int callee = AddBlock(0x80005000, 4, {});
+	EXPECT_TRUE(IsLinked(caller, 0x80005000));
+
+	// Replace the callee with a version that also covers the code it calls.
+	m_cache->DestroyBlockForRecompile(callee);
+	EXPECT_FALSE(IsLinked(caller, 0x80005000));
+
+	int hot = m_cache->AllocateBlock(0x80005000);
+	JitBlock* b = m_cache->GetBlock(hot);
+	b->checkedEntry = m_code;
+	b->normalEntry = m_code;
+	b->codeSize = 0;
+	b->originalSize = 8;
+	b->physicalRanges.push_back(std::make_pair(0x5000u, 0x500Fu));
+	b->physicalRanges.push_back(std::make_pair(0x9000u, 0x900Fu));
+	m_cache->FinalizeBlock(hot, true, m_code);
+	EXPECT_TRUE(IsLinked(caller, 0x80005000));
+
+	// Writing to the followed code has to throw away the hot block as well.
+	m_cache->InvalidateICache(0x80009000, 32, false);
+	EXPECT_EQ(-1, m_cache->GetBlockNumberFromStartAddress(0x80005000));
+	EXPECT_FALSE(IsLinked(caller, 0x80005000));
+	EXPECT_EQ(caller, m_cache->GetBlockNumberFromStartAddress(0x80003000));
+}
+
+TEST_F(JitCacheTest, FreeAndReuse)
+{
+	int caller = AddBlock(0x80003000, 4, { 0x80005000 });
+	int callee = AddBlock(0x80005000, 4, { 0x80003000 });
+	EXPECT_TRUE(IsLinked(caller, 0x80005000));
+
+	// Evicting the callee unlinks the caller, and its number is reused.
+	m_cache->FreeBlock(callee);
+	EXPECT_FALSE(IsLinked(caller, 0x80005000));
+	EXPECT_EQ(-1, m_cache->GetBlockNumberFromStartAddress(0x80005000));
+
+	// Freeing twice must not hand out the same number twice.
+	m_cache->FreeBlock(callee);
+	int other = AddBlock(0x80007000, 4, {});
+	EXPECT_EQ(callee, other);
+	int another = AddBlock(0x80008000, 4, {});
+	EXPECT_NE(other, another);
+
+	m_cache->FreeBlock(caller);
+	int recompiled = AddBlock(0x80003000, 4, {});
+	EXPECT_EQ(caller, recompiled);
+	EXPECT_EQ(recompiled, m_cache->GetBlockNumberFromStartAddress(0x80003000));
+
+	// Linking still works for blocks compiled into reused numbers.
+	int callee_again = AddBlock(0x80005000, 4, {});
+	EXPECT_EQ(callee_again, m_cache->GetBlockNumberFromStartAddress(0x80005000));
+	int caller_of_callee = AddBlock(0x80009000, 4, { 0x80005000 });
+	EXPECT_TRUE(IsLinked(caller_of_callee, 0x80005000));
+}
+
+TEST_F(JitCacheTest, Benchmark)
+{
+	// Roughly what a big title keeps around: tens of thousands of short
+	// blocks, each falling through to the next and calling a few functions.
+	const u32 BASE = 0x80004000;
+	const u32 BLOCK_BYTES = 0x40;
+	const int NUM_BLOCKS = 60000;
+	const int FRAMES = 200;
+	const u32 FRAME_BYTES = 0x4000;
+
+	auto block_address = [&](int i) { return BASE + i * BLOCK_BYTES; };
+
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < NUM_BLOCKS; i++)
+		AddBlock(block_address(i), BLOCK_BYTES / 4, { block_address(i + 1), block_address((i * 7919) % NUM_BLOCKS) });
+	auto created = std::chrono::high_resolution_clock::now();
+
+	// Code that is DMAed in every frame: drop a region the way dcbi/icbi
+	// would, one cache line at a time, then compile it again.
+	int num_rebuilt = 0;
+	for (int frame = 0; frame < FRAMES && !m_cache->IsFull(); frame++)
+	{
+		u32 region = BASE + ((frame * 0x12345) % (NUM_BLOCKS * BLOCK_BYTES - FRAME_BYTES) & ~(BLOCK_BYTES - 1));
+		for (u32 addr = region; addr < region + FRAME_BYTES; addr += 32)
+			m_cache->InvalidateICache(addr, 32, false);
+		for (u32 addr = region; addr < region + FRAME_BYTES && !m_cache->IsFull(); addr += BLOCK_BYTES)
+		{
+			AddBlock(addr, BLOCK_BYTES / 4, { addr + BLOCK_BYTES, BASE });
+			num_rebuilt++;
+		}
+	}
+	auto churned = std::chrono::high_resolution_clock::now();
+
+	m_cache->InvalidateICache(BASE, NUM_BLOCKS * BLOCK_BYTES, true);
+	auto invalidated = std::chrono::high_resolution_clock::now();
+
+	for (int i = 0; i < NUM_BLOCKS; i++)
+		EXPECT_EQ(-1, m_cache->GetBlockNumberFromStartAddress(block_address(i)));
+
+	#define AS_US(diff) ((unsigned long long)std::chrono::duration_cast<std::chrono::microseconds>(diff).count())
+
+	printf("block cache timing:\n");
+	printf("create+link %d blocks       %llu us\n", NUM_BLOCKS, AS_US(created - start));
+	printf("invalidate+rebuild %d blocks %llu us\n", num_rebuilt, AS_US(churned - created));
+	printf("invalidate everything       %llu us\n", AS_US(invalidated - churned));
+}
@@ -1,8 +1,17 @@
+#include <array>
 #include <unordered_set>
-#include <gtest/gtest.h>
 
 #include "Common/CommonTypes.h"
+#include "Common/x64ABI.h"
 #include "Core/HW/MMIO.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "Core/PowerPC/JitCommon/JitBase.h"
+#include "Core/PowerPC/JitCommon/Jit_Util.h"
+
+// include order is important
+#include <gtest/gtest.h>
+
+using namespace Gen;
 
 // Tests that the UniqueID function returns a "unique enough" identifier
 // number: that is, it is unique in the address ranges we care about.
@@ -108,3 +117,238 @@ TEST_F(MappingTest, ReadWriteComplex)
 	EXPECT_TRUE(read_called);
 	EXPECT_TRUE(write_called);
 }
+
+// Records which handling method a handler uses.
+template <typename T>
+class MethodKind : public MMIO::ReadHandlingMethodVisitor<T>,
+                   public MMIO::WriteHandlingMethodVisitor<T>
+{
+public:
+	enum Kind { CONSTANT, NOP, DIRECT, COMPLEX };
+	Kind kind;
+
+	virtual void VisitConstant(T value) { kind = CONSTANT; }
+	virtual void VisitNop() { kind = NOP; }
+	virtual void VisitDirect(const T* addr, u32 mask) { kind = DIRECT; }
+	virtual void VisitDirect(T* addr, u32 mask) { kind = DIRECT; }
+	virtual void VisitComplex(const std::function<T(u32)>* lambda) { kind = COMPLEX; }
+	virtual void VisitComplex(const std::function<void(u32, T)>* lambda) { kind = COMPLEX; }
+};
+
+template <typename T>
+static typename MethodKind<T>::Kind ReadKind(MMIO::Mapping* mapping, u32 addr)
+{
+	MethodKind<T> v;
+	mapping->GetHandlerForRead<T>(addr).Visit(v);
+	return v.kind;
+}
+
+template <typename T>
+static typename MethodKind<T>::Kind WriteKind(MMIO::Mapping* mapping, u32 addr)
+{
+	MethodKind<T> v;
+	mapping->GetHandlerForWrite<T>(addr).Visit(v);
+	return v.kind;
+}
+
+TEST_F(MappingTest, SizeConvertersCombineDirect)
+{
+	// Two 16 bit registers backed by consecutive halves of a u32, and a 32 bit
+	// register whose halves are the wrong way around.
+	u16 regs[4] = {};
+	m_mapping->Register(0xCC001000, MMIO::DirectRead<u16>(&regs[1]), MMIO::DirectWrite<u16>(&regs[1], 0xFF0F));
+	m_mapping->Register(0xCC001002, MMIO::DirectRead<u16>(&regs[0], 0x7FFF), MMIO::DirectWrite<u16>(&regs[0]));
+	m_mapping->Register(0xCC001004, MMIO::DirectRead<u16>(&regs[2]), MMIO::DirectWrite<u16>(&regs[2]));
+	m_mapping->Register(0xCC001006, MMIO::DirectRead<u16>(&regs[3]), MMIO::DirectWrite<u16>(&regs[3]));
+	m_mapping->Register(0xCC001008, MMIO::Constant<u16>(0x1234), MMIO::Nop<u16>());
+	m_mapping->Register(0xCC00100A, MMIO::Constant<u16>(0x5678), MMIO::Nop<u16>());
+	for (u32 addr = 0xCC001000; addr < 0xCC00100C; addr += 4)
+	{
+		m_mapping->Register(addr,
+			MMIO::ReadToSmaller<u32>(m_mapping, addr, addr + 2),
+			MMIO::WriteToSmaller<u32>(m_mapping, addr, addr + 2));
+	}
+	for (u32 addr = 0xCC001000; addr < 0xCC00100C; addr += 2)
+	{
+		m_mapping->RegisterRead(addr, MMIO::ReadToLarger<u8>(m_mapping, addr, 8));
+		m_mapping->RegisterRead(addr + 1, MMIO::ReadToLarger<u8>(m_mapping, addr, 0));
+	}
+
+	EXPECT_EQ(MethodKind<u32>::DIRECT, ReadKind<u32>(m_mapping, 0xCC001000));
+	EXPECT_EQ(MethodKind<u32>::DIRECT, WriteKind<u32>(m_mapping, 0xCC001000));
+	EXPECT_EQ(MethodKind<u32>::COMPLEX, ReadKind<u32>(m_mapping, 0xCC001004));
+	EXPECT_EQ(MethodKind<u32>::COMPLEX, WriteKind<u32>(m_mapping, 0xCC001004));
+	EXPECT_EQ(MethodKind<u32>::CONSTANT, ReadKind<u32>(m_mapping, 0xCC001008));
+	EXPECT_EQ(MethodKind<u32>::NOP, WriteKind<u32>(m_mapping, 0xCC001008));
+	EXPECT_EQ(MethodKind<u8>::DIRECT, ReadKind<u8>(m_mapping, 0xCC001001));
+	EXPECT_EQ(MethodKind<u8>::CONSTANT, ReadKind<u8>(m_mapping, 0xCC00100A));
+
+	// The combined handlers have to behave exactly like the separate ones.
+	m_mapping->Write<u32>(0xCC001000, 0xABCDEF12);
+	EXPECT_EQ(0xAB0Du, regs[1]);
+	EXPECT_EQ(0xEF12u, regs[0]);
+	EXPECT_EQ(0xAB0D6F12u, m_mapping->Read<u32>(0xCC001000));
+	EXPECT_EQ(0xABu, m_mapping->Read<u8>(0xCC001000));
+	EXPECT_EQ(0x0Du, m_mapping->Read<u8>(0xCC001001));
+	EXPECT_EQ(0x6Fu, m_mapping->Read<u8>(0xCC001002));
+
+	m_mapping->Write<u32>(0xCC001004, 0x11223344);
+	EXPECT_EQ(0x1122u, regs[2]);
+	EXPECT_EQ(0x3344u, regs[3]);
+	EXPECT_EQ(0x11223344u, m_mapping->Read<u32>(0xCC001004));
+
+	EXPECT_EQ(0x12345678u, m_mapping->Read<u32>(0xCC001008));
+	EXPECT_EQ(0x56u, m_mapping->Read<u8>(0xCC00100A));
+}
+
+TEST_F(MappingTest, AccessCounts)
+{
+	u32 target = 0;
+	m_mapping->Register(0xCC001234, MMIO::DirectRead<u32>(&target), MMIO::DirectWrite<u32>(&target));
+	m_mapping->Register(0xCD006400, MMIO::Constant<u16>(0), MMIO::Nop<u16>());
+
+	// Nothing is counted until it is enabled.
+	m_mapping->Read<u32>(0xCC001234);
+	EXPECT_FALSE(m_mapping->IsCountingAccesses());
+	EXPECT_TRUE(m_mapping->GetAccessCounts().empty());
+
+	m_mapping->EnableAccessCounting();
+	for (int i = 0; i < 3; ++i)
+		m_mapping->Read<u32>(0xCC001234);
+	m_mapping->Write<u32>(0xCC001234, 1);
+	m_mapping->Write<u16>(0xCD006400, 1);
+	m_mapping->Write<u16>(0xCD806400, 1);
+
+	auto counts = m_mapping->GetAccessCounts();
+	ASSERT_EQ(2u, counts.size());
+	EXPECT_EQ(0xCC001234u, counts[0].address);
+	EXPECT_EQ(3u, counts[0].reads);
+	EXPECT_EQ(1u, counts[0].writes);
+	// The mirror counts as the same register.
+	EXPECT_EQ(0xCD006400u, counts[1].address);
+	EXPECT_EQ(0u, counts[1].reads);
+	EXPECT_EQ(2u, counts[1].writes);
+}
+
+// Emits MMIO accesses the way the JIT does for constant addresses, each in a
+// function of its own.
+class MMIOTestCode : public EmuCodeBlock
+{
+public:
+	MMIOTestCode()
+	{
+		AllocCodeSpace(4096);
+	}
+
+	~MMIOTestCode()
+	{
+		FreeCodeSpace();
+	}
+
+	u32 (*EmitLoad(MMIO::Mapping* mapping, u32 address, int size, bool sign_extend))()
+	{
+		auto func = (u32 (*)())AlignCode16();
+		ABI_PushRegistersAndAdjustStack({RPPCSTATE}, 8);
+		MOV(64, R(RPPCSTATE), ImmPtr((u8*)&PowerPC::ppcState + 0x80));
+		MMIOLoadToReg(mapping, ABI_RETURN, BitSet32(), address, size, sign_extend);
+		ABI_PopRegistersAndAdjustStack({RPPCSTATE}, 8);
+		RET();
+		return func;
+	}
+
+	// Stores the function's argument, or the given immediate if there is one.
+	void (*EmitStore(MMIO::Mapping* mapping, u32 address, int size, const OpArg* imm = nullptr))(u32)
+	{
+		auto func = (void (*)(u32))AlignCode16();
+		ABI_PushRegistersAndAdjustStack({RPPCSTATE}, 8);
+		MOV(64, R(RPPCSTATE), ImmPtr((u8*)&PowerPC::ppcState + 0x80));
+		// Upper bits the handlers must not see.
+		if (size < 32)
+			OR(32, R(ABI_PARAM1), Imm32(0xFFFFFFFF << size));
+		MMIOWriteRegToAddr(mapping, imm ? *imm : R(ABI_PARAM1), BitSet32(), address, size, 0x80001234);
+		ABI_PopRegistersAndAdjustStack({RPPCSTATE}, 8);
+		RET();
+		return func;
+	}
+};
+
+TEST_F(MappingTest, JitDirect)
+{
+	u32 target_32 = 0;
+	u16 target_16 = 0;
+	u8 target_8 = 0;
+	m_mapping->Register(0xCC001000, MMIO::DirectRead<u32>(&target_32), MMIO::DirectWrite<u32>(&target_32, 0x00FFFFF0));
+	m_mapping->Register(0xCC001004, MMIO::DirectRead<u16>(&target_16, 0xFF00), MMIO::DirectWrite<u16>(&target_16));
+	m_mapping->Register(0xCC001006, MMIO::DirectRead<u8>(&target_8), MMIO::DirectWrite<u8>(&target_8));
+
+	MMIOTestCode code;
+	code.EmitStore(m_mapping, 0xCC001000, 32)(0x12345678);
+	EXPECT_EQ(0x00345670u, target_32);
+	EXPECT_EQ(0x00345670u, code.EmitLoad(m_mapping, 0xCC001000, 32, false)());
+
+	OpArg imm = Imm32(0xFFFFFFFF);
+	code.EmitStore(m_mapping, 0xCC001000, 32, &imm)(0);
+	EXPECT_EQ(0x00FFFFF0u, target_32);
+
+	code.EmitStore(m_mapping, 0xCC001004, 16)(0x89AB);
+	EXPECT_EQ(0x89ABu, target_16);
+	EXPECT_EQ(0x8900u, code.EmitLoad(m_mapping, 0xCC001004, 16, false)());
+	EXPECT_EQ(0xFFFF8900u, code.EmitLoad(m_mapping, 0xCC001004, 16, true)());
+
+	code.EmitStore(m_mapping, 0xCC001006, 8)(0x7F);
+	EXPECT_EQ(0x7Fu, target_8);
+	// The neighbouring register is untouched.
+	EXPECT_EQ(0x89ABu, target_16);
+}
+
+TEST_F(MappingTest, JitComplex)
+{
+	u32 written_addr = 0;
+	u32 written_val = 0;
+	m_mapping->Register(0xCC001234,
+		MMIO::ComplexRead<u16>([](u32 addr) {
+			return (u16)(addr >> 4);
+		}),
+		MMIO::ComplexWrite<u16>([&](u32 addr, u16 val) {
+			written_addr = addr;
+			written_val = val;
+		})
+	);
+	m_mapping->Register(0xCC001238, MMIO::Constant<u8>(0x80), MMIO::Nop<u8>());
+
+	MMIOTestCode code;
+	PowerPC::ppcState.pc = 0;
+	code.EmitStore(m_mapping, 0xCC001234, 16)(0xBEEF);
+	EXPECT_EQ(0xCC001234u, written_addr);
+	EXPECT_EQ(0xBEEFu, written_val);
+	// Handlers can see which instruction did the write.
+	EXPECT_EQ(0x80001234u, PowerPC::ppcState.pc);
+
+	OpArg imm = Imm16(0x1234);
+	code.EmitStore(m_mapping, 0xCC001234, 16, &imm)(0);
+	EXPECT_EQ(0x1234u, written_val);
+
+	EXPECT_EQ(0x0123u, code.EmitLoad(m_mapping, 0xCC001234, 16, false)());
+	EXPECT_EQ(0xFFFFFF80u, code.EmitLoad(m_mapping, 0xCC001238, 8, true)());
+	code.EmitStore(m_mapping, 0xCC001238, 8)(0x12);
+}
+
+TEST_F(MappingTest, JitAccessCounts)
+{
+	u32 target = 0;
+	m_mapping->Register(0xCC001000, MMIO::DirectRead<u32>(&target), MMIO::DirectWrite<u32>(&target));
+	m_mapping->EnableAccessCounting();
+
+	MMIOTestCode code;
+	auto load = code.EmitLoad(m_mapping, 0xCC001000, 32, false);
+	auto store = code.EmitStore(m_mapping, 0xCC001000, 32);
+	for (u32 i = 0; i < 5; ++i)
+		store(i);
+	for (u32 i = 0; i < 3; ++i)
+		EXPECT_EQ(4u, load());
+
+	auto counts = m_mapping->GetAccessCounts();
+	ASSERT_EQ(1u, counts.size());
+	EXPECT_EQ(3u, counts[0].reads);
+	EXPECT_EQ(5u, counts[0].writes);
+}
@@ -0,0 +1,186 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <memory>
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Core/ConfigManager.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PowerPC/PowerPC.h"
+
+// Sets up a hashed page table in emulated RAM the way a game's MMU setup code
+// would and checks that translated accesses and the soft TLB agree with it.
+class MMUTest : public testing::Test
+{
+protected:
+	enum
+	{
+		PAGE_TABLE = 0x01000000, // 64 KiB, the smallest table SDR1 can describe
+		VSID = 0x123,
+	};
+
+	static void SetUpTestCase()
+	{
+		// Never shut down, since that would save the settings to the user directory.
+		SConfig::Init();
+	}
+
+	void SetUp() override
+	{
+		SConfig::GetInstance().m_LocalCoreStartupParameter.bMMU = true;
+		SConfig::GetInstance().m_LocalCoreStartupParameter.bBAT = false;
+		SConfig::GetInstance().m_LocalCoreStartupParameter.bWii = false;
+
+		// Memory::Init() needs a video backend for the MMIO handlers, and
+		// nothing here touches MMIO, so just provide a GameCube's worth of RAM.
+		m_ram.reset(new u8[Memory::RAM_SIZE]());
+		Memory::m_pRAM = m_ram.get();
+		Memory::base = m_ram.get();
+		Memory::m_pEXRAM = nullptr;
+		Memory::bFakeVMEM = false;
+
+		PowerPC::ppcState.Exceptions = 0;
+		for (u32& sr : PowerPC::ppcState.sr)
+			sr = VSID;
+		PowerPC::ppcState.spr[SPR_SDR] = PAGE_TABLE;
+		Memory::SDRUpdated();
+		for (u32 set = 0; set <= HW_PAGE_INDEX_MASK; set++)
+			Memory::InvalidateTLBEntry(set << HW_PAGE_INDEX_SHIFT);
+	}
+
+	void TearDown() override
+	{
+		Memory::m_pRAM = nullptr;
+		Memory::base = nullptr;
+	}
+
+	static u32 PTEGAddress(u32 effective_address)
+	{
+		u32 hash = VSID ^ ((effective_address >> 12) & 0xffff);
+		return ((hash & PowerPC::ppcState.pagetable_hashmask) << 6) | PowerPC::ppcState.pagetable_base;
+	}
+
+	// Adds a primary PTE mapping a page, or updates the one that is there.
+	void MapPage(u32 effective_address, u32 physical_address)
+	{
+		u32 pte1 = 0x80000000 | (VSID << 7) | ((effective_address >> 22) & 0x3f);
+		u32 pteg = PTEGAddress(effective_address);
+		for (u32 pte = pteg; pte < pteg + 64; pte += 8)
+		{
+			u32 old = Memory::Read_U32(pte);
+			if (old == pte1 || !(old & 0x80000000))
+			{
+				Memory::Write_U32(pte1, pte);
+				Memory::Write_U32((physical_address & ~0xfff) | 2, pte + 4);
+				return;
+			}
+		}
+		FAIL() << "PTEG full";
+	}
+
+	u32 GetPTE2(u32 effective_address)
+	{
+		u32 pte1 = 0x80000000 | (VSID << 7) | ((effective_address >> 22) & 0x3f);
+		u32 pteg = PTEGAddress(effective_address);
+		for (u32 pte = pteg; pte < pteg + 64; pte += 8)
+		{
+			if (Memory::Read_U32(pte) == pte1)
+				return Memory::Read_U32(pte + 4);
+		}
+		return 0;
+	}
+
+	static const Memory::SoftTLBEntry& SoftTLB(const Memory::SoftTLBEntry* table, u32 effective_address)
+	{
+		return table[(effective_address >> 12) & Memory::SOFT_TLB_MASK];
+	}
+
+	std::unique_ptr<u8[]> m_ram;
+};
+
+TEST_F(MMUTest, TranslatedAccesses)
+{
+	MapPage(0x70000000, 0x00200000);
+	Memory::Write_U32(0x12345678, 0x00200010);
+
+	EXPECT_EQ(0x12345678u, Memory::Read_U32(0x70000010));
+	EXPECT_EQ(0x70000000u, SoftTLB(Memory::soft_tlb_read, 0x70000000).tag);
+	// Served by the soft TLB this time.
+	EXPECT_EQ(0x5678u, Memory::Read_U16(0x70000012));
+
+	Memory::Write_U32(0xCAFEBABE, 0x70000020);
+	EXPECT_EQ(0xCAFEBABEu, Memory::Read_U32(0x00200020));
+	EXPECT_EQ(0x70000000u, SoftTLB(Memory::soft_tlb_write, 0x70000000).tag);
+	// The walk has to set the referenced and changed bits before the page can
+	// be written to without going through the TLB.
+	EXPECT_EQ(0x180u, GetPTE2(0x70000000) & 0x180);
+
+	Memory::Write_U8(0x42, 0x70000FFF);
+	EXPECT_EQ(0x42u, Memory::Read_U8(0x00200FFF));
+	EXPECT_EQ(0u, PowerPC::ppcState.Exceptions);
+}
+
+TEST_F(MMUTest, CrossPageAccess)
+{
+	MapPage(0x70000000, 0x00200000);
+	MapPage(0x70001000, 0x00500000);
+	Memory::Write_U16(0xAABB, 0x00200FFE);
+	Memory::Write_U16(0xCCDD, 0x00500000);
+
+	EXPECT_EQ(0xAABBCCDDu, Memory::Read_U32(0x70000FFE));
+	Memory::Write_U32(0x11223344, 0x70000FFE);
+	EXPECT_EQ(0x1122u, Memory::Read_U16(0x00200FFE));
+	EXPECT_EQ(0x3344u, Memory::Read_U16(0x00500000));
+}
+
+TEST_F(MMUTest, UnmappedPage)
+{
+	EXPECT_EQ(0u, Memory::Read_U32(0x70100000));
+	EXPECT_NE(0u, PowerPC::ppcState.Exceptions & EXCEPTION_DSI);
+	EXPECT_EQ(0x70100000u, PowerPC::ppcState.spr[SPR_DAR]);
+	EXPECT_NE(0x70100000u, SoftTLB(Memory::soft_tlb_read, 0x70100000).tag);
+}
+
+TEST_F(MMUTest, InvalidateOnTLBIE)
+{
+	MapPage(0x70000000, 0x00200000);
+	Memory::Write_U32(1, 0x00200000);
+	Memory::Write_U32(2, 0x00300000);
+	EXPECT_EQ(1u, Memory::Read_U32(0x70000000));
+
+	// Without a tlbie the old translation stays in use, like on hardware.
+	MapPage(0x70000000, 0x00300000);
+	EXPECT_EQ(1u, Memory::Read_U32(0x70000000));
+
+	Memory::InvalidateTLBEntry(0x70000000);
+	EXPECT_EQ(Memory::SOFT_TLB_INVALID_TAG, SoftTLB(Memory::soft_tlb_read, 0x70000000).tag);
+	EXPECT_EQ(2u, Memory::Read_U32(0x70000000));
+}
+
+TEST_F(MMUTest, InvalidateOnTLBEviction)
+{
+	// Three pages in the same set of the two-way emulated TLB, but in
+	// different soft TLB entries.
+	MapPage(0x70000000, 0x00200000);
+	MapPage(0x70040000, 0x00210000);
+	MapPage(0x70080000, 0x00220000);
+	Memory::Read_U32(0x70000000);
+	Memory::Read_U32(0x70040000);
+	EXPECT_EQ(0x70000000u, SoftTLB(Memory::soft_tlb_read, 0x70000000).tag);
+	Memory::Read_U32(0x70080000);
+	EXPECT_EQ(Memory::SOFT_TLB_INVALID_TAG, SoftTLB(Memory::soft_tlb_read, 0x70000000).tag);
+	EXPECT_EQ(0x70040000u, SoftTLB(Memory::soft_tlb_read, 0x70040000).tag);
+	EXPECT_EQ(0x70080000u, SoftTLB(Memory::soft_tlb_read, 0x70080000).tag);
+}
+
+TEST_F(MMUTest, FlushOnSDR1Update)
+{
+	MapPage(0x70000000, 0x00200000);
+	Memory::Read_U32(0x70000000);
+	Memory::Write_U32(0, 0x70000000);
+	Memory::SDRUpdated();
+	EXPECT_EQ(Memory::SOFT_TLB_INVALID_TAG, SoftTLB(Memory::soft_tlb_read, 0x70000000).tag);
+	EXPECT_EQ(Memory::SOFT_TLB_INVALID_TAG, SoftTLB(Memory::soft_tlb_write, 0x70000000).tag);
+}
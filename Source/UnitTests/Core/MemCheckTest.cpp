@@ -0,0 +1,92 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <memory>
+#include <gtest/gtest.h>
+
+#include "Common/BreakPoints.h"
+#include "Common/CommonTypes.h"
+#include "Core/ConfigManager.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PowerPC/PowerPC.h"
+
+// Memchecks used to only be checked in debug builds; the Read_*/Write_*
+// functions, which JIT code ends up calling for watched pages, now always
+// check them.
+class MemCheckTest : public testing::Test
+{
+protected:
+	static void SetUpTestCase()
+	{
+		// Never shut down, since that would save the settings to the user directory.
+		SConfig::Init();
+	}
+
+	void SetUp() override
+	{
+		SConfig::GetInstance().m_LocalCoreStartupParameter.bMMU = false;
+		SConfig::GetInstance().m_LocalCoreStartupParameter.bWii = false;
+
+		// Memory::Init() needs a video backend for the MMIO handlers, and
+		// nothing here touches MMIO, so just provide a GameCube's worth of RAM.
+		m_ram.reset(new u8[Memory::RAM_SIZE]());
+		Memory::m_pRAM = m_ram.get();
+		Memory::base = m_ram.get();
+		Memory::bFakeVMEM = false;
+	}
+
+	void TearDown() override
+	{
+		PowerPC::memchecks.Clear();
+		Memory::m_pRAM = nullptr;
+		Memory::base = nullptr;
+	}
+
+	static TMemCheck MakeMemCheck(u32 start, u32 end, bool on_read, bool on_write)
+	{
+		TMemCheck mc;
+		mc.StartAddress = start;
+		mc.EndAddress = end;
+		mc.bRange = start != end;
+		mc.OnRead = on_read;
+		mc.OnWrite = on_write;
+		return mc;
+	}
+
+	std::unique_ptr<u8[]> m_ram;
+};
+
+TEST_F(MemCheckTest, Hits)
+{
+	PowerPC::memchecks.Add(MakeMemCheck(0x80001000, 0x80001000, true, true));
+	ASSERT_TRUE(PowerPC::memchecks.HasAny());
+
+	Memory::Write_U32(0x12345678, 0x80001000);
+	EXPECT_EQ(0x12345678u, Memory::Read_U32(0x80001000));
+	EXPECT_EQ(0x1234u, Memory::Read_U16(0x80001000));
+	// Only accesses starting at the watched address count.
+	Memory::Read_U32(0x80001004);
+	Memory::Write_U8(0, 0x80000FFF);
+	EXPECT_EQ(3u, PowerPC::memchecks.GetMemCheck(0x80001000)->numHits);
+}
+
+TEST_F(MemCheckTest, Ranges)
+{
+	PowerPC::memchecks.Add(MakeMemCheck(0x80002000, 0x80002FFF, false, true));
+	PowerPC::memchecks.Add(MakeMemCheck(0x80004000, 0x80004000, true, false));
+
+	Memory::Write_U64(0, 0x80002000);
+	Memory::Write_U16(0, 0x80002FFE);
+	Memory::Write_U16(0, 0x80003000);
+	EXPECT_EQ(2u, PowerPC::memchecks.GetMemCheck(0x80002800)->numHits);
+	EXPECT_EQ(nullptr, PowerPC::memchecks.GetMemCheck(0x80003000));
+
+	PowerPC::memchecks.Remove(0x80002000);
+	EXPECT_EQ(nullptr, PowerPC::memchecks.GetMemCheck(0x80002800));
+	EXPECT_TRUE(PowerPC::memchecks.HasAny());
+
+	PowerPC::memchecks.Clear();
+	EXPECT_FALSE(PowerPC::memchecks.HasAny());
+	Memory::Read_U32(0x80004000);
+}
@@ -0,0 +1,91 @@
+// Copyright 2015 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Common/FileUtil.h"
+#include "Common/Thread.h"
+#include "Core/PowerPC/PPCSymbolDB.h"
+#include "Core/PowerPC/Profiler.h"
+
+// include order is important
+#include <gtest/gtest.h>
+
+class CallStackProfilerTest : public testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		// Data symbols, so PPCSymbolDB doesn't try to analyze code in guest memory.
+		g_symbolDB.AddKnownSymbol(0x80001000, 0x100, "main", Symbol::SYMBOL_DATA);
+		g_symbolDB.AddKnownSymbol(0x80002000, 0x100, "Draw", Symbol::SYMBOL_DATA);
+		g_symbolDB.AddKnownSymbol(0x80003000, 0x100, "memcpy", Symbol::SYMBOL_DATA);
+		Profiler::ResetCallStacks();
+	}
+
+	void TearDown() override
+	{
+		g_symbolDB.Clear();
+	}
+
+	// Runs a slice ending at pc that takes long enough to show up in the output.
+	void RunSlice(u32 pc)
+	{
+		Profiler::ResumeCallStack();
+		Common::SleepCurrentThread(2);
+		Profiler::SampleCallStack(pc);
+	}
+
+	std::vector<std::string> WriteStacks()
+	{
+		std::string filename = File::GetTempFilenameForAtomicWrite("callstacks.txt");
+		Profiler::WriteCallStacks(filename);
+
+		std::string contents;
+		EXPECT_TRUE(File::ReadFileToString(filename, contents));
+		File::Delete(filename);
+
+		// Only check the stacks, the weights are host time.
+		std::vector<std::string> stacks;
+		std::istringstream lines(contents);
+		std::string line;
+		while (std::getline(lines, line))
+			stacks.push_back(line.substr(0, line.rfind(' ')));
+		return stacks;
+	}
+};
+
+TEST_F(CallStackProfilerTest, CallsAndReturns)
+{
+	RunSlice(0x80001004);
+	Profiler::OnGuestCall(0x80002000, 0x80001010);
+	RunSlice(0x80002040);
+	Profiler::OnGuestCall(0x80003000, 0x80002050);
+	RunSlice(0x80003010);
+	Profiler::OnGuestReturn(0x80002050);
+	Profiler::OnGuestReturn(0x80001010);
+	RunSlice(0x80001020);
+
+	std::vector<std::string> expected = { "Draw", "Draw;memcpy", "main" };
+	EXPECT_EQ(expected, WriteStacks());
+}
+
+TEST_F(CallStackProfilerTest, UnbalancedReturns)
+{
+	Profiler::OnGuestCall(0x80002000, 0x80001010);
+	Profiler::OnGuestCall(0x80003000, 0x80002050);
+
+	// A return we never saw the call for leaves the stack alone...
+	Profiler::OnGuestReturn(0x80004000);
+	RunSlice(0x80003010);
+
+	// ...and one further up drops everything below it.
+	Profiler::OnGuestReturn(0x80001010);
+	RunSlice(0x80001020);
+
+	std::vector<std::string> expected = { "Draw;memcpy", "main" };
+	EXPECT_EQ(expected, WriteStacks());
+}